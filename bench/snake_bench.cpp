@@ -0,0 +1,974 @@
+// Microbenchmarks for the simulation hot paths.
+//
+// Usage: snake_bench [--grids 32,128,512] [--counts 16,256,4096]
+//                    [--filter substring] [--min-time seconds]
+//                    [--format text|csv|json]
+//
+// Every case is run per grid size, and cases that depend on an entity
+// count (snake length, obstacle count) additionally per count. Results are
+// printed as a table, CSV or JSON so runs can be diffed between releases.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "food.h"
+#include "food_pool.h"
+#include "game.h"
+#include "grid_geometry.h"
+#include "hierarchical_planner.h"
+#include "incremental_planner.h"
+#include "obstacle.h"
+#include "occupancy_grid.h"
+#include "path_planner.h"
+#include "plan_budget.h"
+#include "renderer.h"
+#include "snake.h"
+#include "space_check.h"
+#include "space_time_planner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keep the optimizer from discarding a computed value
+template <typename T>
+inline void DoNotOptimize(T const &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+  std::string name;
+  int grid{0};
+  int count{0};
+  long iterations{0};
+  double ns_per_op{0.0};
+  // Optional case-specific metric, e.g. nodes expanded per search
+  std::string metric;
+  double metric_value{0.0};
+};
+
+struct Options {
+  std::vector<int> grids{32, 128, 512};
+  std::vector<int> counts{16, 256, 4096};
+  std::string filter;
+  double min_time{0.2};
+  std::string format{"text"};
+};
+
+// Time `op` in doubling batches until a batch lasts at least min_time.
+// `op` performs one operation per call.
+template <typename Op>
+void Measure(double min_time, Result &result, Op &&op) {
+  long batch = 1;
+  while (true) {
+    auto start = Clock::now();
+    for (long i = 0; i < batch; ++i) {
+      op();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (seconds >= min_time || batch >= (1L << 30)) {
+      result.iterations = batch;
+      result.ns_per_op = seconds * 1e9 / batch;
+      return;
+    }
+    batch *= 2;
+  }
+}
+
+// A snake of exactly `length` segments heading up a grid tall enough that it
+// can never run into itself. Speed 1 makes every Update a cell move.
+Snake MakeLongSnake(int grid, int length) {
+  Snake snake(grid, std::max(grid, length + 2));
+  snake.speed = kSubcellsPerCell;
+  for (int i = 0; i < length; ++i) {
+    snake.GrowBody();
+    snake.Update();
+  }
+  return snake;
+}
+
+// Block roughly `density` of the cells, keeping start and goal free
+void Clutter(OccupancyGrid &world, double density, SDL_Point start,
+             SDL_Point goal) {
+  std::mt19937 engine(42);
+  std::uniform_real_distribution<double> roll(0.0, 1.0);
+  for (int y = 0; y < world.Height(); ++y) {
+    for (int x = 0; x < world.Width(); ++x) {
+      if ((x == start.x && y == start.y) || (x == goal.x && y == goal.y)) {
+        continue;
+      }
+      if (roll(engine) < density) {
+        world.Add(x, y, OccupancyGrid::Layer::kObstacle);
+      }
+    }
+  }
+}
+
+// Wall off a square ring around the goal so the search exhausts the grid
+void EncloseGoal(OccupancyGrid &world, SDL_Point goal) {
+  for (int d = -1; d <= 1; ++d) {
+    for (int e = -1; e <= 1; ++e) {
+      if (d == 0 && e == 0) continue;
+      int x = (goal.x + d + world.Width()) % world.Width();
+      int y = (goal.y + e + world.Height()) % world.Height();
+      world.Add(x, y, OccupancyGrid::Layer::kObstacle);
+    }
+  }
+}
+
+Result BenchPath(const std::string &name, int grid, PathPlanner::Mode mode,
+                 const Options &options,
+                 const std::function<void(OccupancyGrid &, SDL_Point,
+                                           SDL_Point)> &setup) {
+  OccupancyGrid world(grid, grid);
+  SDL_Point start{0, 0};
+  SDL_Point goal{grid / 2, grid / 2};
+  setup(world, start, goal);
+
+  PathPlanner planner(grid, grid);
+  planner.SetMode(mode);
+  std::vector<SDL_Point> path;
+  Result result{name, grid, 0};
+  Measure(options.min_time, result, [&] {
+    DoNotOptimize(planner.FindPath(world, start, goal, path));
+  });
+  result.metric = "expanded";
+  result.metric_value = static_cast<double>(planner.Expanded());
+  return result;
+}
+
+// A* towards a walled-off goal under a time budget, as the AI's pathfinding
+// thread runs it: without one the search exhausts the grid, with one it
+// stops at the deadline with a partial path. The metric is the length of
+// that path.
+Result BenchPathDeadline(const std::string &name, int grid,
+                         std::chrono::microseconds budget,
+                         const Options &options) {
+  OccupancyGrid world(grid, grid);
+  SDL_Point start{0, 0};
+  SDL_Point goal{grid / 2, grid / 2};
+  EncloseGoal(world, goal);
+
+  PathPlanner planner(grid, grid);
+  std::atomic<std::uint64_t> latest{1};
+  std::vector<SDL_Point> path;
+  Result result{name, grid, 0};
+  Measure(options.min_time, result, [&] {
+    PlanBudget plan_budget(PlanBudget::Clock::now() + budget, &latest, 1);
+    DoNotOptimize(planner.FindPath(world, start, goal, plan_budget, path));
+  });
+  result.metric = "partial_length";
+  result.metric_value = static_cast<double>(path.size());
+  return result;
+}
+
+// Hierarchical planning on the maps BenchPath uses. "path" refines the
+// whole route; "abstract" only plans across clusters; "update" toggles one
+// cell per operation first, so the planner rebuilds the clusters it touches,
+// then plans and refines the first leg as the AI does. The metric is the
+// number of abstract nodes expanded, or clusters rebuilt for "update".
+Result BenchHierarchical(const std::string &name, int grid, double density,
+                         const std::string &kind, const Options &options) {
+  OccupancyGrid world(grid, grid);
+  SDL_Point start{0, 0};
+  SDL_Point goal{grid / 2, grid / 2};
+  Clutter(world, density, start, goal);
+
+  std::mt19937 engine(7);
+  std::uniform_int_distribution<int> coord(0, grid - 1);
+  std::vector<SDL_Point> toggles;
+  while (toggles.size() < 64) {
+    SDL_Point cell{coord(engine), coord(engine)};
+    if ((cell.x == start.x && cell.y == start.y) ||
+        (cell.x == goal.x && cell.y == goal.y)) {
+      continue;
+    }
+    toggles.push_back(cell);
+  }
+  std::vector<bool> added(toggles.size(), false);
+
+  HierarchicalPlanner planner(grid, grid);
+  planner.Sync(world);
+  std::vector<SDL_Point> path;
+  std::size_t next = 0;
+  double metric = 0.0;
+  Result result{name, grid, 0};
+  Measure(options.min_time, result, [&] {
+    if (kind == "path") {
+      DoNotOptimize(planner.FindPath(world, start, goal, path));
+      metric += static_cast<double>(planner.Expanded());
+    } else if (kind == "abstract") {
+      DoNotOptimize(planner.PlanAbstract(world, start, goal));
+      metric += static_cast<double>(planner.Expanded());
+    } else {
+      std::size_t i = next & 63;
+      if (added[i]) {
+        world.Remove(toggles[i].x, toggles[i].y,
+                     OccupancyGrid::Layer::kObstacle);
+      } else {
+        world.Add(toggles[i].x, toggles[i].y, OccupancyGrid::Layer::kObstacle);
+      }
+      added[i] = !added[i];
+      planner.Sync(world);
+      metric += static_cast<double>(planner.RebuiltClusters());
+      path.clear();
+      if (planner.PlanAbstract(world, start, goal)) {
+        DoNotOptimize(planner.RefineSegment(world, 0, path));
+      }
+    }
+    next++;
+  });
+  result.metric = kind == "update" ? "rebuilt" : "expanded";
+  result.metric_value = metric / static_cast<double>(next);
+  return result;
+}
+
+// Replan on a cluttered grid after toggling one cell per operation, as the
+// AI does when an obstacle or a snake moves. The incremental planner repairs
+// its tree; the metric is the mean number of nodes expanded per repair.
+Result BenchReplan(const std::string &name, int grid, const Options &options) {
+  OccupancyGrid world(grid, grid);
+  SDL_Point start{0, 0};
+  SDL_Point goal{grid / 2, grid / 2};
+  Clutter(world, 0.3, start, goal);
+
+  std::mt19937 engine(7);
+  std::uniform_int_distribution<int> coord(0, grid - 1);
+  std::vector<SDL_Point> toggles;
+  while (toggles.size() < 64) {
+    SDL_Point cell{coord(engine), coord(engine)};
+    if ((cell.x == start.x && cell.y == start.y) ||
+        (cell.x == goal.x && cell.y == goal.y)) {
+      continue;
+    }
+    toggles.push_back(cell);
+  }
+  std::vector<bool> added(toggles.size(), false);
+
+  IncrementalPlanner planner(grid, grid);
+  std::vector<SDL_Point> path;
+  planner.FindPath(world, start, goal, path);
+
+  std::size_t next = 0;
+  double expanded = 0.0;
+  Result result{name, grid, 0};
+  Measure(options.min_time, result, [&] {
+    std::size_t i = next++ & 63;
+    if (added[i]) {
+      world.Remove(toggles[i].x, toggles[i].y, OccupancyGrid::Layer::kObstacle);
+    } else {
+      world.Add(toggles[i].x, toggles[i].y, OccupancyGrid::Layer::kObstacle);
+    }
+    added[i] = !added[i];
+    DoNotOptimize(planner.FindPath(world, start, goal, path));
+    expanded += static_cast<double>(planner.Expanded());
+  });
+  result.metric = "expanded";
+  result.metric_value = expanded / static_cast<double>(next);
+  return result;
+}
+
+// Choose a food and plan to it on a cluttered grid holding `count` food
+// items, after one item is eaten and respawned elsewhere as in play. The
+// baseline guesses the Manhattan-nearest food and runs A* to it from
+// scratch; the distance field floods from every food at once, finding the
+// nearest reachable one, and repairs its tree as food comes and goes.
+Result BenchFoodTarget(const std::string &name, int grid, int count,
+                       bool field, const Options &options) {
+  OccupancyGrid world(grid, grid);
+  SDL_Point start{0, 0};
+  SDL_Point far{grid / 2, grid / 2};
+  Clutter(world, 0.3, start, far);
+
+  std::mt19937 engine(11);
+  std::uniform_int_distribution<int> coord(0, grid - 1);
+  auto free_cell = [&] {
+    while (true) {
+      SDL_Point cell{coord(engine), coord(engine)};
+      bool at_start = cell.x == start.x && cell.y == start.y;
+      if (world.IsEmpty(cell.x, cell.y) && !at_start) return cell;
+    }
+  };
+  std::vector<SDL_Point> foods;
+  while (static_cast<int>(foods.size()) < count) {
+    foods.push_back(free_cell());
+    world.Add(foods.back().x, foods.back().y, OccupancyGrid::Layer::kFood);
+  }
+
+  PathPlanner astar(grid, grid);
+  IncrementalPlanner planner(grid, grid);
+  std::vector<SDL_Point> path;
+  if (field) planner.FindPath(world, start, OccupancyGrid::Layer::kFood, path);
+
+  std::size_t next = 0;
+  double expanded = 0.0;
+  long ops = 0;
+  Result result{name, grid, count};
+  Measure(options.min_time, result, [&] {
+    SDL_Point &moved = foods[next++ % foods.size()];
+    world.Remove(moved.x, moved.y, OccupancyGrid::Layer::kFood);
+    moved = free_cell();
+    world.Add(moved.x, moved.y, OccupancyGrid::Layer::kFood);
+
+    if (field) {
+      DoNotOptimize(planner.FindPath(world, start, OccupancyGrid::Layer::kFood,
+                                     path));
+      expanded += static_cast<double>(planner.Expanded());
+    } else {
+      SDL_Point target = foods.front();
+      int best = grid * 2;
+      for (const SDL_Point &food : foods) {
+        int dx = std::abs(food.x - start.x);
+        int dy = std::abs(food.y - start.y);
+        if (dx + dy < best) {
+          best = dx + dy;
+          target = food;
+        }
+      }
+      DoNotOptimize(astar.FindPath(world, start, target, path));
+      expanded += static_cast<double>(astar.Expanded());
+    }
+    ops++;
+  });
+  result.metric = "expanded";
+  result.metric_value = expanded / static_cast<double>(ops);
+  return result;
+}
+
+// Plan past a snake body that walls off a whole column but drains from the
+// row the AI wants to cross. The static plan has to go around the torus;
+// the space-time plan crosses once the tail has passed. The metric is the
+// length of the path found.
+Result BenchDrainingWall(const std::string &name, int grid, bool space_time,
+                         const Options &options) {
+  OccupancyGrid world(grid, grid);
+  MotionForecast forecast(grid, grid);
+  SDL_Point start{0, grid / 2};
+  SDL_Point food{12, grid / 2};
+  world.Add(food.x, food.y, OccupancyGrid::Layer::kFood);
+  forecast.goals.push_back(food);
+  for (int i = 0; i < grid; ++i) {
+    int y = (grid / 2 + i) % grid;
+    world.Add(6, y, OccupancyGrid::Layer::kAI);
+    forecast.BlockUntil(6, y, static_cast<std::uint16_t>(i + 1));
+  }
+
+  IncrementalPlanner planner(grid, grid);
+  SpaceTimePlanner space_time_planner;
+  std::vector<SDL_Point> path;
+  Result result{name, grid, 0};
+  Measure(options.min_time, result, [&] {
+    if (space_time) {
+      DoNotOptimize(space_time_planner.FindPath(
+          forecast, start, SpaceTimePlanner::kHorizon, path));
+    } else {
+      planner.Reset();
+      DoNotOptimize(planner.FindPath(world, start, food, path));
+    }
+  });
+  result.metric = "path_length";
+  result.metric_value = static_cast<double>(path.size());
+  return result;
+}
+
+// Count every free cell reachable from a corner of a cluttered grid, as the
+// AI's survival check does when it is boxed in. The baseline is a plain
+// breadth-first search over cells; SpaceCheck floods a bitboard a word at a
+// time. The metric is the number of cells reached.
+Result BenchSpaceCheck(const std::string &name, int grid, bool bitboard,
+                       const Options &options) {
+  OccupancyGrid world(grid, grid);
+  SDL_Point start{0, 0};
+  Clutter(world, 0.3, start, start);
+
+  SpaceCheck check(grid, grid);
+  check.Sync(world);
+  std::vector<std::uint8_t> seen;
+  std::queue<int> frontier;
+  int reached = 0;
+  Result result{name, grid, 0};
+  Measure(options.min_time, result, [&] {
+    if (bitboard) {
+      reached = check.Reachable(start, start, grid * grid);
+    } else {
+      seen.assign(static_cast<std::size_t>(grid) * grid, 0);
+      seen[0] = 1;
+      frontier.push(0);
+      reached = 0;
+      while (!frontier.empty()) {
+        int cell = frontier.front();
+        frontier.pop();
+        reached++;
+        int x = cell % grid;
+        int y = cell / grid;
+        const int neighbors[4] = {y * grid + (x + 1) % grid,
+                                  y * grid + (x + grid - 1) % grid,
+                                  (y + 1) % grid * grid + x,
+                                  (y + grid - 1) % grid * grid + x};
+        for (int next : neighbors) {
+          if (seen[next] || world.IsBlocked(next % grid, next / grid)) continue;
+          seen[next] = 1;
+          frontier.push(next);
+        }
+      }
+    }
+    DoNotOptimize(reached);
+  });
+  result.metric = "reached";
+  result.metric_value = reached;
+  return result;
+}
+
+// Cell arithmetic as the searches did it before GridGeometry: every split
+// of a cell index divides
+struct DividingGeometry {
+  int width;
+  int height;
+  int Cell(int x, int y) const { return y * width + x; }
+  int X(int cell) const { return cell % width; }
+  int Y(int cell) const { return cell / width; }
+  int Right(int x) const { return x + 1 == width ? 0 : x + 1; }
+  int Left(int x) const { return x == 0 ? width - 1 : x - 1; }
+  int Down(int y) const { return y + 1 == height ? 0 : y + 1; }
+  int Up(int y) const { return y == 0 ? height - 1 : y - 1; }
+};
+
+// Breadth-first flood of a whole empty torus: split each cell, step to its
+// four neighbours and join them again, the inner loop every search shares
+template <typename Geometry>
+int FloodTorus(const Geometry &grid, std::vector<int> &queue,
+               std::vector<std::uint32_t> &seen, std::uint32_t stamp) {
+  queue.clear();
+  queue.push_back(0);
+  seen[0] = stamp;
+  for (std::size_t head = 0; head < queue.size(); ++head) {
+    int cell = queue[head];
+    int x = grid.X(cell);
+    int y = grid.Y(cell);
+    const int neighbors[4] = {
+        grid.Cell(grid.Right(x), y), grid.Cell(grid.Left(x), y),
+        grid.Cell(x, grid.Down(y)), grid.Cell(x, grid.Up(y))};
+    for (int next : neighbors) {
+      if (seen[next] == stamp) continue;
+      seen[next] = stamp;
+      queue.push_back(next);
+    }
+  }
+  return static_cast<int>(queue.size());
+}
+
+// The flood with cells split by division, by GridGeometry's run-time mask,
+// and by Grid<W, H> with the size compiled in (sizes WithGeometry does not
+// specialize fall back to GridGeometry). The metric is cells reached.
+enum class GeometryKind { kDivide, kRuntime, kStatic };
+
+Result BenchGeometry(const std::string &name, int grid, GeometryKind kind,
+                     const Options &options) {
+  std::vector<int> queue;
+  queue.reserve(static_cast<std::size_t>(grid) * grid);
+  std::vector<std::uint32_t> seen(static_cast<std::size_t>(grid) * grid, 0);
+  std::uint32_t stamp = 0;
+  GridGeometry geometry(grid, grid);
+  int reached = 0;
+  Result result{name, grid, 0};
+  Measure(options.min_time, result, [&] {
+    ++stamp;
+    switch (kind) {
+      case GeometryKind::kDivide:
+        reached = FloodTorus(DividingGeometry{grid, grid}, queue, seen, stamp);
+        break;
+      case GeometryKind::kRuntime:
+        reached = FloodTorus(geometry, queue, seen, stamp);
+        break;
+      case GeometryKind::kStatic:
+        reached = WithGeometry(geometry, [&](const auto &g) {
+          return FloodTorus(g, queue, seen, stamp);
+        });
+        break;
+    }
+    DoNotOptimize(reached);
+  });
+  result.metric = "reached";
+  result.metric_value = reached;
+  return result;
+}
+
+// Whole matches with inline AI planning, timed per simulated tick, either
+// stepping every tick or skipping from one event to the next. Building a
+// board is left out of the timing.
+Result BenchGameTicks(const std::string &name, int grid, bool fast_forward,
+                      const Options &options) {
+  constexpr long kMatchTicks = 5000;
+  Game::Options game_options;
+  game_options.threaded_ai = false;
+  Game::StepInput no_input;
+  long ticks = 0, steps = 0;
+  double seconds = 0.0;
+  for (std::uint32_t seed = 1; seed <= 64 && seconds < options.min_time;
+       ++seed) {
+    game_options.seed = seed;
+    Game game(grid, grid, game_options);
+    auto start = Clock::now();
+    long t = 0;
+    while (t < kMatchTicks && !game.IsOver()) {
+      game.Step(no_input);
+      t++;
+      steps++;
+      if (fast_forward) t += game.FastForward(kMatchTicks - t);
+    }
+    seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    ticks += t;
+  }
+  Result result{name, grid, 0};
+  result.iterations = ticks;
+  result.ns_per_op = seconds * 1e9 / std::max(ticks, 1L);
+  result.metric = "stepped";
+  result.metric_value = static_cast<double>(steps) / std::max(ticks, 1L);
+  return result;
+}
+
+std::vector<Result> RunAll(const Options &options) {
+  std::vector<Result> results;
+  auto wanted = [&](const std::string &name) {
+    return options.filter.empty() ||
+           name.find(options.filter) != std::string::npos;
+  };
+
+  for (int grid : options.grids) {
+    int cells = grid * grid;
+
+    for (int count : options.counts) {
+      if (wanted("snake_update")) {
+        Snake snake = MakeLongSnake(grid, count);
+        Result result{"snake_update", grid, count};
+        Measure(options.min_time, result, [&] {
+          snake.GrowBody();  // keep the length constant while moving
+          snake.Update();
+          snake.size--;
+        });
+        results.push_back(result);
+      }
+
+      if (wanted("snake_cell")) {
+        Snake snake = MakeLongSnake(grid, count);
+        int height = std::max(grid, count + 2);
+        std::mt19937 engine(7);
+        std::vector<SDL_Point> queries(1024);
+        for (auto &query : queries) {
+          query = {static_cast<int>(engine() % grid),
+                   static_cast<int>(engine() % height)};
+        }
+        std::size_t next = 0;
+        Result result{"snake_cell", grid, count};
+        Measure(options.min_time, result, [&] {
+          const SDL_Point &query = queries[next++ & 1023];
+          DoNotOptimize(snake.SnakeCell(query.x, query.y));
+        });
+        results.push_back(result);
+      }
+
+      if (count >= cells) continue;
+
+      if (wanted("obstacle_is_at") || wanted("obstacle_check_collision")) {
+        OccupancyGrid world(grid, grid);
+        ObstacleManager obstacles(grid, grid, count / 2, count - count / 2,
+                                  world, 11);
+        SnakeBody body(grid, grid);
+        std::mt19937 engine(13);
+        std::vector<SDL_Point> queries(1024);
+        for (auto &query : queries) {
+          query = {static_cast<int>(engine() % grid),
+                   static_cast<int>(engine() % grid)};
+        }
+        std::size_t next = 0;
+
+        if (wanted("obstacle_is_at")) {
+          Result result{"obstacle_is_at", grid, count};
+          Measure(options.min_time, result, [&] {
+            const SDL_Point &query = queries[next++ & 1023];
+            DoNotOptimize(obstacles.IsObstacleAt(query.x, query.y));
+          });
+          results.push_back(result);
+        }
+        if (wanted("obstacle_check_collision")) {
+          Result result{"obstacle_check_collision", grid, count};
+          Measure(options.min_time, result, [&] {
+            const SDL_Point &query = queries[next++ & 1023];
+            DoNotOptimize(obstacles.CheckCollision(body, query.x, query.y));
+          });
+          results.push_back(result);
+        }
+      }
+
+      // One obstacle update moving `count` obstacles (half of them fixed),
+      // and a forecast of the moving ones' next 16 updates
+      if (wanted("obstacle_update") || wanted("obstacle_forecast")) {
+        OccupancyGrid world(grid, grid);
+        ObstacleManager obstacles(grid, grid, count / 2, count - count / 2,
+                                  world, 11);
+        if (wanted("obstacle_update")) {
+          Result result{"obstacle_update", grid, count};
+          Measure(options.min_time, result, [&] { obstacles.Update(); });
+          results.push_back(result);
+        }
+        if (wanted("obstacle_forecast")) {
+          MotionForecast forecast(grid, grid);
+          Result result{"obstacle_forecast", grid, count};
+          Measure(options.min_time, result, [&] {
+            obstacles.Forecast(16, 1, 15, forecast);
+            DoNotOptimize(forecast.moving_cells.data());
+          });
+          results.push_back(result);
+        }
+      }
+
+      // The nearest of `count` foods: a scan of every item, as the game
+      // used to do per move, against the pool's bucket rings
+      if (wanted("food_nearest_scan") || wanted("food_nearest_buckets")) {
+        FoodPool pool(grid, grid, static_cast<std::size_t>(count));
+        std::mt19937 engine(31);
+        while (static_cast<int>(pool.Size()) < count) {
+          int x = static_cast<int>(engine() % grid);
+          int y = static_cast<int>(engine() % grid);
+          if (pool.At(x, y) == nullptr) {
+            pool.Add(Food(x, y, Food::Type::Normal));
+          }
+        }
+        std::vector<SDL_Point> queries(1024);
+        for (auto &query : queries) {
+          query = {static_cast<int>(engine() % grid),
+                   static_cast<int>(engine() % grid)};
+        }
+        std::size_t next = 0;
+
+        if (wanted("food_nearest_scan")) {
+          Result result{"food_nearest_scan", grid, count};
+          Measure(options.min_time, result, [&] {
+            const SDL_Point &query = queries[next++ & 1023];
+            int best = 2 * grid;
+            for (const Food &food : pool.Items()) {
+              int dx = std::abs(food.GetX() - query.x);
+              int dy = std::abs(food.GetY() - query.y);
+              best = std::min(best, std::min(dx, grid - dx) +
+                                        std::min(dy, grid - dy));
+            }
+            DoNotOptimize(best);
+          });
+          results.push_back(result);
+        }
+        if (wanted("food_nearest_buckets")) {
+          Result result{"food_nearest_buckets", grid, count};
+          SDL_Point food;
+          int distance = 0;
+          Measure(options.min_time, result, [&] {
+            const SDL_Point &query = queries[next++ & 1023];
+            DoNotOptimize(pool.Nearest(query, food, distance));
+          });
+          results.push_back(result);
+        }
+      }
+    }
+
+    // The same maps for plain A* and jump point search: empty, sparse as in
+    // large open levels, cluttered, and with the goal walled off
+    const std::pair<PathPlanner::Mode, const char *> path_modes[] = {
+        {PathPlanner::Mode::kAStar, "astar"},
+        {PathPlanner::Mode::kJumpPoint, "jps"}};
+    for (const auto &mode : path_modes) {
+      std::string prefix = std::string("path_") + mode.second + "_";
+      if (wanted(prefix + "empty")) {
+        results.push_back(
+            BenchPath(prefix + "empty", grid, mode.first, options,
+                      [](OccupancyGrid &, SDL_Point, SDL_Point) {}));
+      }
+      if (wanted(prefix + "sparse")) {
+        results.push_back(BenchPath(
+            prefix + "sparse", grid, mode.first, options,
+            [](OccupancyGrid &world, SDL_Point start, SDL_Point goal) {
+              Clutter(world, 0.05, start, goal);
+            }));
+      }
+      if (wanted(prefix + "cluttered")) {
+        results.push_back(BenchPath(
+            prefix + "cluttered", grid, mode.first, options,
+            [](OccupancyGrid &world, SDL_Point start, SDL_Point goal) {
+              Clutter(world, 0.3, start, goal);
+            }));
+      }
+      if (wanted(prefix + "unreachable")) {
+        results.push_back(BenchPath(
+            prefix + "unreachable", grid, mode.first, options,
+            [](OccupancyGrid &world, SDL_Point, SDL_Point goal) {
+              EncloseGoal(world, goal);
+            }));
+      }
+    }
+
+    for (const char *kind : {"path", "abstract", "update"}) {
+      const std::pair<double, const char *> maps[] = {{0.05, "sparse"},
+                                                      {0.3, "cluttered"}};
+      for (const auto &map : maps) {
+        std::string name =
+            std::string("path_hpa_") + kind + "_" + map.second;
+        if (wanted(name)) {
+          results.push_back(
+              BenchHierarchical(name, grid, map.first, kind, options));
+        }
+      }
+    }
+
+    if (wanted("path_astar_deadline_200us")) {
+      results.push_back(BenchPathDeadline("path_astar_deadline_200us", grid,
+                                          std::chrono::microseconds(200),
+                                          options));
+    }
+
+    if (wanted("path_dstar_replan")) {
+      results.push_back(BenchReplan("path_dstar_replan", grid, options));
+    }
+    const std::pair<GeometryKind, const char *> geometries[] = {
+        {GeometryKind::kDivide, "geometry_flood_divide"},
+        {GeometryKind::kRuntime, "geometry_flood_runtime"},
+        {GeometryKind::kStatic, "geometry_flood_static"}};
+    for (const auto &geometry : geometries) {
+      if (wanted(geometry.second)) {
+        results.push_back(
+            BenchGeometry(geometry.second, grid, geometry.first, options));
+      }
+    }
+    if (wanted("space_check_bfs")) {
+      results.push_back(BenchSpaceCheck("space_check_bfs", grid, false,
+                                        options));
+    }
+    if (wanted("space_check_bitboard")) {
+      results.push_back(BenchSpaceCheck("space_check_bitboard", grid, true,
+                                        options));
+    }
+    if (wanted("path_drain_static")) {
+      results.push_back(
+          BenchDrainingWall("path_drain_static", grid, false, options));
+    }
+    if (wanted("path_drain_space_time")) {
+      results.push_back(
+          BenchDrainingWall("path_drain_space_time", grid, true, options));
+    }
+    for (int food_count : {1, 8, 64}) {
+      if (food_count >= cells / 4) continue;
+      if (wanted("food_target_nearest_astar")) {
+        results.push_back(BenchFoodTarget("food_target_nearest_astar", grid,
+                                          food_count, false, options));
+      }
+      if (wanted("food_target_field")) {
+        results.push_back(BenchFoodTarget("food_target_field", grid,
+                                          food_count, true, options));
+      }
+    }
+
+    if (wanted("game_tick_step")) {
+      results.push_back(BenchGameTicks("game_tick_step", grid, false,
+                                       options));
+    }
+    if (wanted("game_tick_fast_forward")) {
+      results.push_back(BenchGameTicks("game_tick_fast_forward", grid, true,
+                                       options));
+    }
+
+    if (wanted("place_food_nearly_full")) {
+      // 95% of the placeable cells hold fixed obstacles
+      Game::Options game_options;
+      game_options.enable_ai = false;
+      game_options.seed = 17;
+      game_options.num_fixed_obstacles =
+          static_cast<std::size_t>((cells - 81) * 0.95);
+      game_options.num_moving_obstacles = 0;
+      game_options.max_food_items = static_cast<std::size_t>(cells);
+
+      Result result{"place_food_nearly_full", grid, 0};
+      long placed = 0, attempts = 0;
+      double seconds = 0.0;
+      // Building a board is far slower than placing food on it, so time a
+      // bounded number of placements on a handful of boards
+      for (int boards = 0; boards < 8 && seconds < options.min_time;
+           ++boards) {
+        Game game(grid, grid, game_options);
+        int free_cells = cells - static_cast<int>(
+                                     game_options.num_fixed_obstacles);
+        // Only a quarter of the free cells, so the board stays nearly full
+        int placements = std::max(1, std::min(4096, free_cells / 4));
+        auto start = Clock::now();
+        for (int i = 0; i < placements; ++i) {
+          placed += game.PlaceFood() ? 1 : 0;
+        }
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        attempts += placements;
+      }
+      result.iterations = attempts;
+      result.ns_per_op = seconds * 1e9 / attempts;
+      result.metric = "success_rate";
+      result.metric_value = static_cast<double>(placed) / attempts;
+      results.push_back(result);
+    }
+
+    // Spawning food of one of `count` types: the alias table draws in the
+    // same time however many types there are, where walking the cumulative
+    // weights (the if-chain the factory used to be) grows with them
+    for (int count : {4, 64}) {
+      FoodRegistry types;
+      for (int i = static_cast<int>(types.Size()); i < count; ++i) {
+        types.Add(FoodTraits{1, 1, 0, 0, {0xFF, 0xFF, 0xFF, 0xFF},
+                             static_cast<std::uint32_t>(1 + i % 7)});
+      }
+      std::mt19937 engine(19);
+      std::uniform_int_distribution<int> coord(0, grid - 1);
+      if (wanted("food_factory_create")) {
+        FoodFactory factory(types);
+        Result result{"food_factory_create", grid, count};
+        Measure(options.min_time, result, [&] {
+          Food food =
+              factory.CreateRandomFood(coord(engine), coord(engine), engine);
+          DoNotOptimize(food);
+        });
+        results.push_back(result);
+      }
+      if (wanted("food_type_linear")) {
+        std::uint32_t total = 0;
+        for (std::size_t i = 0; i < types.Size(); ++i) {
+          total += types.Traits(static_cast<Food::Type>(i)).spawn_weight;
+        }
+        std::uniform_int_distribution<std::uint32_t> roll(0, total - 1);
+        Result result{"food_type_linear", grid, count};
+        Measure(options.min_time, result, [&] {
+          std::uint32_t left = roll(engine);
+          std::size_t type = 0;
+          while (left >= types.Traits(static_cast<Food::Type>(type))
+                             .spawn_weight) {
+            left -= types.Traits(static_cast<Food::Type>(type)).spawn_weight;
+            ++type;
+          }
+          Food food(coord(engine), coord(engine),
+                    static_cast<Food::Type>(type));
+          DoNotOptimize(food);
+        });
+        results.push_back(result);
+      }
+    }
+
+    if (wanted("render_offscreen")) {
+      Game::Options game_options;
+      game_options.threaded_ai = false;
+      game_options.seed = 23;
+      Game game(grid, grid, game_options);
+      Renderer renderer(640, 640, grid, grid, Renderer::Target::kOffscreen);
+      Result result{"render_offscreen", grid, 0};
+      Measure(options.min_time, result, [&] {
+        renderer.Render(game.GetSnake(), game.GetAISnakes(), game.GetFoods(),
+                        game.GetFoodTypes(), game.GetObstacles(), true);
+      });
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+void PrintText(const std::vector<Result> &results) {
+  std::cout << "name                      grid  count  iterations      ns/op"
+               "  metric\n";
+  for (const auto &r : results) {
+    std::printf("%-24s %5d %6d %11ld %10.1f", r.name.c_str(), r.grid, r.count,
+                r.iterations, r.ns_per_op);
+    if (!r.metric.empty()) {
+      std::printf("  %s=%g", r.metric.c_str(), r.metric_value);
+    }
+    std::printf("\n");
+  }
+}
+
+void PrintCsv(const std::vector<Result> &results) {
+  std::cout << "name,grid,count,iterations,ns_per_op,metric,metric_value\n";
+  for (const auto &r : results) {
+    std::cout << r.name << "," << r.grid << "," << r.count << ","
+              << r.iterations << "," << r.ns_per_op << "," << r.metric << ","
+              << r.metric_value << "\n";
+  }
+}
+
+void PrintJson(const std::vector<Result> &results) {
+  std::cout << "[\n";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    std::cout << "  {\"name\": \"" << r.name << "\", \"grid\": " << r.grid
+              << ", \"count\": " << r.count
+              << ", \"iterations\": " << r.iterations
+              << ", \"ns_per_op\": " << r.ns_per_op;
+    if (!r.metric.empty()) {
+      std::cout << ", \"" << r.metric << "\": " << r.metric_value;
+    }
+    std::cout << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  std::cout << "]\n";
+}
+
+std::vector<int> ParseList(const std::string &text) {
+  std::vector<int> values;
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    values.push_back(std::atoi(item.c_str()));
+  }
+  return values;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--grids" && has_value) {
+      options.grids = ParseList(argv[++i]);
+    } else if (arg == "--counts" && has_value) {
+      options.counts = ParseList(argv[++i]);
+    } else if (arg == "--filter" && has_value) {
+      options.filter = argv[++i];
+    } else if (arg == "--min-time" && has_value) {
+      options.min_time = std::atof(argv[++i]);
+    } else if (arg == "--format" && has_value) {
+      options.format = argv[++i];
+    } else {
+      std::cerr << "usage: snake_bench [--grids 32,128,512] "
+                   "[--counts 16,256,4096] [--filter name]\n"
+                   "                   [--min-time seconds] "
+                   "[--format text|csv|json]\n";
+      return 1;
+    }
+  }
+
+  // Game obstacles keep a 9x9 area clear around the spawn point
+  for (int grid : options.grids) {
+    if (grid < 16) {
+      std::cerr << "grid sizes must be at least 16\n";
+      return 1;
+    }
+  }
+
+  std::vector<Result> results = RunAll(options);
+  if (options.format == "json") {
+    PrintJson(results);
+  } else if (options.format == "csv") {
+    PrintCsv(results);
+  } else {
+    PrintText(results);
+  }
+  return 0;
+}
@@ -1,18 +1,25 @@
 #include "ai_snake.h"
 #include <algorithm>
-#include <cmath>
-#include <unordered_map>
+#include <chrono>
+#include <cstdlib>
+#include "profiler.h"
 
 AISnake::AISnake(int grid_width, int grid_height)
     : Snake(grid_width, grid_height),
-      food_target_{0, 0},
-      player_head_{0, 0},
+      snapshots_(WorldSnapshot{OccupancyGrid(grid_width, grid_height),
+                               MotionForecast(grid_width, grid_height),
+                               SDL_Point{0, 0}, 0,
+                               PlanBudget::Clock::time_point{}}),
+      plans_(PlanResult{}),
+      planner_(grid_width, grid_height),
+      path_planner_(grid_width, grid_height),
+      hierarchical_planner_(grid_width, grid_height),
+      space_check_(grid_width, grid_height),
       grid_width_(grid_width),
       grid_height_(grid_height) {
   // Start AI snake in a different position (bottom-right quadrant)
-  head_x = grid_width * 3 / 4;
-  head_y = grid_height * 3 / 4;
-  speed = 0.1f;  // Same speed as player
+  PlaceHead(grid_width * 3 / 4, grid_height * 3 / 4);
+  speed = ToSubcells(0.1);  // Same speed as player
 }
 
 AISnake::~AISnake() {
@@ -21,297 +28,422 @@ AISnake::~AISnake() {
 
 AISnake::AISnake(AISnake&& other) noexcept
     : Snake(std::move(other)),
-      running_(other.running_.load()),
-      food_target_(other.food_target_),
-      obstacles_(std::move(other.obstacles_)),
-      player_snake_body_(std::move(other.player_snake_body_)),
-      player_head_(other.player_head_),
+      snapshots_(std::move(other.snapshots_)),
+      plans_(std::move(other.plans_)),
+      request_generation_(other.request_generation_.load()),
+      plan_budget_(other.plan_budget_),
+      cancelled_(other.cancelled_),
+      planned_(other.planned_),
+      planned_version_(other.planned_version_),
+      published_generation_(other.published_generation_),
+      plan_stats_(other.plan_stats_),
+      planner_choice_(other.planner_choice_),
+      planner_(std::move(other.planner_)),
+      path_planner_(std::move(other.path_planner_)),
+      hierarchical_planner_(std::move(other.hierarchical_planner_)),
+      space_time_planner_(std::move(other.space_time_planner_)),
+      static_path_(std::move(other.static_path_)),
+      space_check_(std::move(other.space_check_)),
       current_path_(std::move(other.current_path_)),
       path_index_(other.path_index_),
       grid_width_(other.grid_width_),
-      grid_height_(other.grid_height_) {
-  other.running_ = false;
-}
+      grid_height_(other.grid_height_) {}
 
 AISnake& AISnake::operator=(AISnake&& other) noexcept {
   if (this != &other) {
     StopAI();
     Snake::operator=(std::move(other));
-    running_ = other.running_.load();
-    food_target_ = other.food_target_;
-    obstacles_ = std::move(other.obstacles_);
-    player_snake_body_ = std::move(other.player_snake_body_);
-    player_head_ = other.player_head_;
+    snapshots_ = std::move(other.snapshots_);
+    plans_ = std::move(other.plans_);
+    request_generation_ = other.request_generation_.load();
+    plan_budget_ = other.plan_budget_;
+    cancelled_ = other.cancelled_;
+    planned_ = other.planned_;
+    planned_version_ = other.planned_version_;
+    published_generation_ = other.published_generation_;
+    plan_stats_ = other.plan_stats_;
+    planner_choice_ = other.planner_choice_;
+    planner_ = std::move(other.planner_);
+    path_planner_ = std::move(other.path_planner_);
+    hierarchical_planner_ = std::move(other.hierarchical_planner_);
+    space_time_planner_ = std::move(other.space_time_planner_);
+    static_path_ = std::move(other.static_path_);
+    space_check_ = std::move(other.space_check_);
     current_path_ = std::move(other.current_path_);
     path_index_ = other.path_index_;
     grid_width_ = other.grid_width_;
     grid_height_ = other.grid_height_;
-    other.running_ = false;
   }
   return *this;
 }
 
-void AISnake::StartAI() {
-  if (running_) return;
-
-  running_ = true;
-  path_promise_ = std::promise<std::vector<SDL_Point>>();
-  path_future_ = path_promise_.get_future();
+void AISnake::StartAI(PlanningService& service) {
+  if (service_) return;
 
-  pathfinding_thread_ = std::thread(&AISnake::PathfindingThread, this);
+  service_ = &service;
 }
 
 void AISnake::StopAI() {
-  if (!running_) return;
+  if (!service_) return;
 
-  running_ = false;
-
-  // Wake up thread if waiting
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    path_requested_ = true;
-  }
-  path_cv_.notify_one();
+  // Cut short whatever is being planned, then wait for it to end
+  request_generation_.store(++published_generation_,
+                            std::memory_order_relaxed);
+  service_->Withdraw(*this);
+  service_ = nullptr;
+}
 
-  if (pathfinding_thread_.joinable()) {
-    pathfinding_thread_.join();
+void AISnake::PublishWorld(const OccupancyGrid& world) {
+  planned_ = true;
+  planned_version_ = world.Version();
+
+  // The write slot belongs to this thread alone and already holds the
+  // forecast, so publishing neither allocates nor waits for the planner
+  WorldSnapshot& snapshot = snapshots_.WriteBuffer();
+  snapshot.grid.CatchUp(world);
+  snapshot.head = HeadCell();
+  snapshot.generation = ++published_generation_;
+  snapshot.published = PlanBudget::Clock::now();
+
+  // Cancel the search for the previous snapshot. Bumped before publishing
+  // so no search can start on this snapshot and see itself as outdated.
+  request_generation_.store(published_generation_, std::memory_order_relaxed);
+  snapshots_.Publish();
+
+  if (service_) {
+    int steps_left = static_cast<int>(current_path_.size() - path_index_);
+    service_->Submit(*this, std::max(steps_left, 0));
   }
 }
 
-void AISnake::SetFoodTarget(int x, int y) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  food_target_.x = x;
-  food_target_.y = y;
-  path_requested_ = true;
-  path_cv_.notify_one();
+void AISnake::PlanPath(const OccupancyGrid& world,
+                       const MotionForecast& forecast) {
+  planned_ = true;
+  planned_version_ = world.Version();
+  plan_stats_.inline_plans++;
+
+  SDL_Point start = HeadCell();
+  PlanBudget unlimited;
+  CalculatePath(world, forecast, start, unlimited, current_path_);
+  path_index_ = 0;
 }
 
-void AISnake::SetObstacles(const std::vector<SDL_Point>& obstacles) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  obstacles_ = obstacles;
+void AISnake::SetPlanner(Planner planner) {
+  planner_choice_ = planner;
+  path_planner_.SetMode(planner == Planner::kJumpPoint
+                            ? PathPlanner::Mode::kJumpPoint
+                            : PathPlanner::Mode::kAStar);
 }
 
-void AISnake::SetPlayerSnakeBody(const std::vector<SDL_Point>& body,
-                                  int head_x, int head_y) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  player_snake_body_ = body;
-  player_head_.x = head_x;
-  player_head_.y = head_y;
+bool AISnake::ParsePlanner(const std::string& name, Planner& planner) {
+  if (name == "dstar") {
+    planner = Planner::kDStarLite;
+  } else if (name == "astar") {
+    planner = Planner::kAStar;
+  } else if (name == "jps") {
+    planner = Planner::kJumpPoint;
+  } else if (name == "hpa") {
+    planner = Planner::kHierarchical;
+  } else {
+    return false;
+  }
+  return true;
 }
 
 bool AISnake::HasValidPath() const {
-  std::lock_guard<std::mutex> lock(mutex_);
   return !current_path_.empty() && path_index_ < current_path_.size();
 }
 
-void AISnake::PathfindingThread() {
-  while (running_) {
-    // Wait for path request using condition variable
-    std::unique_lock<std::mutex> lock(mutex_);
-    path_cv_.wait(lock, [this] { return path_requested_ || !running_; });
-
-    if (!running_) break;
-
-    path_requested_ = false;
-
-    // Copy data needed for pathfinding
-    SDL_Point start{static_cast<int>(head_x), static_cast<int>(head_y)};
-    SDL_Point goal = food_target_;
-    (void)obstacles_;        // Used via member access in IsWalkable
-    (void)player_snake_body_; // Used via member access in IsWalkable
-
-    lock.unlock();
-
-    // Calculate path (outside of lock)
-    auto new_path = CalculatePath(start, goal);
-
-    // Update the path using promise/future pattern
-    lock.lock();
-    current_path_ = std::move(new_path);
-    path_index_ = 0;
-    lock.unlock();
+void AISnake::Plan() {
+  // Requests coalesce, so there may be nothing newer than the last plan
+  if (!snapshots_.Acquire()) return;
+
+  // The read slot stays ours until the next Acquire(), so the search sees
+  // one consistent world without copying it again
+  const WorldSnapshot& snapshot = snapshots_.ReadBuffer();
+  PlanBudget budget(plan_budget_.count() > 0
+                        ? snapshot.published + plan_budget_
+                        : PlanBudget::Clock::time_point::max(),
+                    &request_generation_, snapshot.generation);
+  PlanResult& result = plans_.WriteBuffer();
+  CalculatePath(snapshot.grid, snapshot.forecast, snapshot.head, budget,
+                result.path);
+
+  // A newer snapshot is waiting, and is already queued; its plan is the one
+  // worth delivering
+  if (budget.Cancelled()) {
+    cancelled_++;
+    return;
   }
+  result.generation = snapshot.generation;
+  result.published = snapshot.published;
+  result.partial = budget.DeadlineHit();
+  result.cancelled = cancelled_;
+  plans_.Publish();
 }
 
-void AISnake::UpdateAI() {
+void AISnake::UpdateAI(const OccupancyGrid& world) {
   if (!alive) return;
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  // Adopt the newest path from the pathfinding thread. Swapping hands our
+  // old vector back for reuse, so steady state does not allocate.
+  if (plans_.Acquire()) {
+    PlanResult& result = plans_.ReadBuffer();
+    current_path_.swap(result.path);
+    path_index_ = 0;
+    RecordPlan(result);
+  }
 
-  if (current_path_.empty() || path_index_ >= current_path_.size()) {
-    // No valid path, move randomly to avoid getting stuck
-    return;
+  int current_x = HeadX();
+  int current_y = HeadY();
+
+  // Skip a waypoint we are already standing on (a path planned from the
+  // cell we just left)
+  if (path_index_ < current_path_.size() &&
+      current_path_[path_index_].x == current_x &&
+      current_path_[path_index_].y == current_y) {
+    path_index_++;
   }
 
-  // Get next position in path
-  SDL_Point next = current_path_[path_index_];
-  int current_x = static_cast<int>(head_x);
-  int current_y = static_cast<int>(head_y);
-
-  // Determine direction to next cell
-  int dx = next.x - current_x;
-  int dy = next.y - current_y;
-
-  // Handle wrapping
-  if (dx > grid_width_ / 2) dx -= grid_width_;
-  if (dx < -grid_width_ / 2) dx += grid_width_;
-  if (dy > grid_height_ / 2) dy -= grid_height_;
-  if (dy < -grid_height_ / 2) dy += grid_height_;
-
-  // Set direction based on delta
-  if (std::abs(dx) > std::abs(dy)) {
-    if (dx > 0) direction = Direction::kRight;
-    else if (dx < 0) direction = Direction::kLeft;
-  } else {
-    if (dy > 0) direction = Direction::kDown;
-    else if (dy < 0) direction = Direction::kUp;
+  if (path_index_ < current_path_.size()) {
+    // Get next position in path
+    SDL_Point next = current_path_[path_index_];
+
+    // Determine direction to next cell
+    int dx = next.x - current_x;
+    int dy = next.y - current_y;
+
+    // Handle wrapping
+    if (dx > grid_width_ / 2) dx -= grid_width_;
+    if (dx < -grid_width_ / 2) dx += grid_width_;
+    if (dy > grid_height_ / 2) dy -= grid_height_;
+    if (dy < -grid_height_ / 2) dy += grid_height_;
+
+    // Set direction based on delta
+    if (std::abs(dx) > std::abs(dy)) {
+      if (dx > 0) direction = Direction::kRight;
+      else if (dx < 0) direction = Direction::kLeft;
+    } else {
+      if (dy > 0) direction = Direction::kDown;
+      else if (dy < 0) direction = Direction::kUp;
+    }
   }
 
-  // Check if we've reached the next waypoint
-  if (current_x == next.x && current_y == next.y) {
-    path_index_++;
+  // Judge the move as the head is about to make it. The path may lead
+  // through a cell that was forecast to clear but has not, or it may
+  // predate the world as it is now; and reaching food is no use if the
+  // snake is then boxed into a pocket smaller than itself.
+  if (EntersNextCell()) {
+    SDL_Point ahead = CellTowards(direction);
+    if (!CanEnter(world, ahead) || !HasRoom(world, ahead)) {
+      current_path_.clear();
+      path_index_ = 0;
+      SteerToSafety(world);
+    }
   }
 
   // Call parent Update (handles actual movement)
   // Note: Update() is called separately in Game::Update()
 }
 
-std::vector<SDL_Point> AISnake::CalculatePath(SDL_Point start, SDL_Point goal) {
-  // A* pathfinding implementation
-  std::vector<std::unique_ptr<PathNode>> all_nodes;
-  auto hash = [this](const SDL_Point& p) {
-    return p.y * grid_width_ + p.x;
-  };
-
-  std::unordered_map<int, PathNode*> node_map;
-  std::priority_queue<PathNode*, std::vector<PathNode*>,
-                      std::function<bool(PathNode*, PathNode*)>> open_set(
-      [](PathNode* a, PathNode* b) { return a->f_cost() > b->f_cost(); });
-  std::unordered_set<int> closed_set;
-
-  // Create start node
-  auto start_node = std::make_unique<PathNode>();
-  start_node->x = start.x;
-  start_node->y = start.y;
-  start_node->g_cost = 0;
-  start_node->h_cost = Heuristic(start.x, start.y, goal.x, goal.y);
-  start_node->parent = nullptr;
-
-  int start_hash = hash(start);
-  node_map[start_hash] = start_node.get();
-  open_set.push(start_node.get());
-  all_nodes.push_back(std::move(start_node));
-
-  while (!open_set.empty()) {
-    PathNode* current = open_set.top();
-    open_set.pop();
-
-    int current_hash = current->y * grid_width_ + current->x;
-
-    if (closed_set.count(current_hash)) continue;
-    closed_set.insert(current_hash);
-
-    // Check if reached goal
-    if (current->x == goal.x && current->y == goal.y) {
-      return ReconstructPath(current);
-    }
-
-    // Explore neighbors
-    for (const auto& neighbor_pos : GetNeighbors(current->x, current->y)) {
-      int neighbor_hash = hash(neighbor_pos);
-
-      if (closed_set.count(neighbor_hash)) continue;
-      if (!IsWalkable(neighbor_pos.x, neighbor_pos.y)) continue;
-
-      int tentative_g = current->g_cost + 1;
-
-      PathNode* neighbor_node = nullptr;
-      if (node_map.count(neighbor_hash)) {
-        neighbor_node = node_map[neighbor_hash];
-        if (tentative_g >= neighbor_node->g_cost) continue;
-      } else {
-        auto new_node = std::make_unique<PathNode>();
-        new_node->x = neighbor_pos.x;
-        new_node->y = neighbor_pos.y;
-        neighbor_node = new_node.get();
-        node_map[neighbor_hash] = neighbor_node;
-        all_nodes.push_back(std::move(new_node));
-      }
+void AISnake::RecordPlan(const PlanResult& result) {
+  double latency_ms = std::chrono::duration<double, std::milli>(
+                          PlanBudget::Clock::now() - result.published)
+                          .count();
+  std::uint64_t staleness = published_generation_ - result.generation;
+  plan_stats_.delivered++;
+  if (result.partial) plan_stats_.partial++;
+  plan_stats_.cancelled = result.cancelled;
+  plan_stats_.total_latency_ms += latency_ms;
+  plan_stats_.max_latency_ms = std::max(plan_stats_.max_latency_ms, latency_ms);
+  plan_stats_.total_staleness += staleness;
+  plan_stats_.max_staleness = std::max(plan_stats_.max_staleness, staleness);
+}
 
-      neighbor_node->g_cost = tentative_g;
-      neighbor_node->h_cost = Heuristic(neighbor_pos.x, neighbor_pos.y,
-                                        goal.x, goal.y);
-      neighbor_node->parent = current;
-      open_set.push(neighbor_node);
-    }
+SDL_Point AISnake::CellTowards(Direction dir) const {
+  int x = HeadX();
+  int y = HeadY();
+  switch (dir) {
+    case Direction::kUp: y = (y == 0 ? grid_height_ : y) - 1; break;
+    case Direction::kDown: y = (y + 1) % grid_height_; break;
+    case Direction::kLeft: x = (x == 0 ? grid_width_ : x) - 1; break;
+    case Direction::kRight: x = (x + 1) % grid_width_; break;
   }
-
-  // No path found, return empty
-  return {};
+  return SDL_Point{x, y};
 }
 
-int AISnake::Heuristic(int x1, int y1, int x2, int y2) const {
-  // Manhattan distance with wrapping consideration
-  int dx = std::abs(x2 - x1);
-  int dy = std::abs(y2 - y1);
+bool AISnake::CanEnter(const OccupancyGrid& world, SDL_Point cell) const {
+  // Our own tail is the exception: it moves off in the same update
+  bool own_tail = !body.empty() && !IsGrowing() &&
+                  body.front().x == cell.x && body.front().y == cell.y;
+  return !world.Has(cell.x, cell.y, OccupancyGrid::Layer::kObstacle) &&
+         !world.Has(cell.x, cell.y, OccupancyGrid::Layer::kPlayer) &&
+         (!world.Has(cell.x, cell.y, OccupancyGrid::Layer::kAI) || own_tail);
+}
 
-  // Account for wrapping
-  dx = std::min(dx, grid_width_ - dx);
-  dy = std::min(dy, grid_height_ - dy);
+int AISnake::LengthAfterMove() const {
+  return static_cast<int>(body.size()) + 1 + (IsGrowing() ? 1 : 0);
+}
 
-  return dx + dy;
+SDL_Point AISnake::DepartingTail(SDL_Point fallback) const {
+  if (body.empty() || IsGrowing()) return fallback;
+  return body.front();
 }
 
-std::vector<SDL_Point> AISnake::GetNeighbors(int x, int y) const {
-  std::vector<SDL_Point> neighbors;
+bool AISnake::HasRoom(const OccupancyGrid& world, SDL_Point cell) {
+  PROFILE_ZONE("SpaceCheck");
+  space_check_.Sync(world);
+  int length = LengthAfterMove();
+  return space_check_.Reachable(cell, DepartingTail(cell), length) >= length;
+}
 
-  // Four cardinal directions with wrapping
-  neighbors.push_back({(x + 1) % grid_width_, y});
-  neighbors.push_back({(x - 1 + grid_width_) % grid_width_, y});
-  neighbors.push_back({x, (y + 1) % grid_height_});
-  neighbors.push_back({x, (y - 1 + grid_height_) % grid_height_});
+void AISnake::SteerToSafety(const OccupancyGrid& world) {
+  PROFILE_ZONE("SpaceCheck");
+  space_check_.Sync(world);
+  int length = LengthAfterMove();
+
+  // Best first: room for the whole body, then a way to follow our own tail
+  // (which keeps opening space ahead of us), then simply the most room
+  enum Rank { kTrapped, kChasesTail, kRoomy };
+  Rank best_rank = kTrapped;
+  int best_score = -1;
+  Direction best = direction;
+  for (Direction dir : {direction, Direction::kUp, Direction::kRight,
+                        Direction::kDown, Direction::kLeft}) {
+    SDL_Point cell = CellTowards(dir);
+    if (!CanEnter(world, cell)) continue;
+
+    SDL_Point tail = DepartingTail(cell);
+    int area = space_check_.Reachable(cell, tail, length);
+    Rank rank = kTrapped;
+    int score = area;
+    if (area >= length) {
+      rank = kRoomy;
+      score = 0;  // keep the first, preferring to carry straight on
+    } else if (tail.x != cell.x || tail.y != cell.y) {
+      if (space_check_.Reached(tail.x, tail.y)) {
+        rank = kChasesTail;
+        int dx = std::abs(tail.x - cell.x);
+        int dy = std::abs(tail.y - cell.y);
+        score = -(std::min(dx, grid_width_ - dx) +
+                  std::min(dy, grid_height_ - dy));
+      }
+    }
+    if (rank > best_rank || (rank == best_rank && score > best_score)) {
+      best_rank = rank;
+      best_score = score;
+      best = dir;
+    }
+  }
+  direction = best;
+}
 
-  return neighbors;
+bool AISnake::EntersNextCell() const {
+  SDL_Point next = NextHeadCell();
+  return next.x != HeadX() || next.y != HeadY();
 }
 
-bool AISnake::IsWalkable(int x, int y) const {
-  // Check against own body
-  for (const auto& segment : body) {
-    if (segment.x == x && segment.y == y) return false;
+bool AISnake::IsClearInTime(const MotionForecast& forecast,
+                            const std::vector<SDL_Point>& path) {
+  for (std::size_t i = 0; i < path.size(); ++i) {
+    if (!forecast.IsFree(path[i].x, path[i].y, static_cast<int>(i) + 1)) {
+      return false;
+    }
   }
+  return true;
+}
 
-  // Check against obstacles
-  for (const auto& obstacle : obstacles_) {
-    if (obstacle.x == x && obstacle.y == y) return false;
+int AISnake::PlanStatic(const OccupancyGrid& world,
+                        const MotionForecast& forecast, SDL_Point head,
+                        PlanBudget& budget, std::vector<SDL_Point>& path) {
+  if (planner_choice_ == Planner::kDStarLite) {
+    PROFILE_ZONE("DStarLite");
+    bool found =
+        planner_.FindPath(world, head, OccupancyGrid::Layer::kFood, path);
+    return found ? static_cast<int>(path.size()) : -1;
   }
 
-  // Check against player snake body
-  for (const auto& segment : player_snake_body_) {
-    if (segment.x == x && segment.y == y) return false;
+  // The other searches need a single goal: the food nearest as the crow
+  // flies
+  path.clear();
+  if (forecast.goals.empty()) return -1;
+  SDL_Point goal = forecast.goals.front();
+  int best = grid_width_ + grid_height_;
+  for (const SDL_Point& food : forecast.goals) {
+    int dx = std::abs(food.x - head.x);
+    int dy = std::abs(food.y - head.y);
+    int distance = std::min(dx, grid_width_ - dx) +
+                   std::min(dy, grid_height_ - dy);
+    if (distance < best) {
+      best = distance;
+      goal = food;
+    }
   }
 
-  // Check against player head
-  if (player_head_.x == x && player_head_.y == y) return false;
+  if (planner_choice_ == Planner::kHierarchical) {
+    PROFILE_ZONE("Hierarchical");
+    if (!hierarchical_planner_.PlanAbstract(world, head, goal)) return -1;
+    // Replanning comes long before the head gets further than the
+    // time-aware search looks ahead
+    const auto& waypoints = hierarchical_planner_.Waypoints();
+    for (std::size_t i = 0;
+         i + 1 < waypoints.size() &&
+         static_cast<int>(path.size()) < SpaceTimePlanner::kHorizon &&
+         !budget.Expired();
+         ++i) {
+      if (!hierarchical_planner_.RefineSegment(world, i, path)) {
+        path.clear();
+        return -1;
+      }
+    }
+    return hierarchical_planner_.PlanLength();
+  }
 
-  return true;
+  bool found;
+  if (planner_choice_ == Planner::kJumpPoint) {
+    PROFILE_ZONE("JumpPoint");
+    found = path_planner_.FindPath(world, head, goal, budget, path);
+  } else {
+    PROFILE_ZONE("AStar");
+    found = path_planner_.FindPath(world, head, goal, budget, path);
+  }
+  return found ? static_cast<int>(path.size()) : -1;
 }
 
-std::vector<SDL_Point> AISnake::ReconstructPath(PathNode* end_node) {
-  std::vector<SDL_Point> path;
-  PathNode* current = end_node;
-
-  while (current != nullptr) {
-    path.push_back({current->x, current->y});
-    current = current->parent;
+bool AISnake::CalculatePath(const OccupancyGrid& world,
+                            const MotionForecast& forecast, SDL_Point head,
+                            PlanBudget& budget, std::vector<SDL_Point>& path) {
+  int length = PlanStatic(world, forecast, head, budget, static_path_);
+  bool found = length >= 0;
+  // Out of time or superseded: settle for what the static search has
+  if (budget.Expired()) {
+    path.swap(static_path_);
+    return !path.empty();
   }
 
-  // Reverse to get path from start to goal
-  std::reverse(path.begin(), path.end());
-
-  // Skip first node (current position)
-  if (!path.empty()) {
-    path.erase(path.begin());
+  // A static path as short as the open-field distance cannot be beaten, so
+  // it only needs checking against the forecast. Otherwise its length
+  // bounds the time-aware search.
+  int horizon = SpaceTimePlanner::kHorizon;
+  if (found) {
+    if (length <= space_time_planner_.Distance(forecast, head) &&
+        IsClearInTime(forecast, static_path_)) {
+      path.swap(static_path_);
+      return true;
+    }
+    horizon = std::min(horizon, length);
+  }
+  {
+    PROFILE_ZONE("SpaceTime");
+    if (space_time_planner_.FindPath(forecast, head, horizon, budget,
+                                     path)) {
+      return true;
+    }
+    // Cut short: the partial time-aware path is safe as far as it goes,
+    // which the static one may not be
+    if (budget.DeadlineHit() && !path.empty()) return true;
   }
 
-  return path;
+  path.swap(static_path_);
+  return found;
 }
@@ -2,33 +2,39 @@
 #define AI_SNAKE_H
 
 #include "snake.h"
+#include "occupancy_grid.h"
+#include "hierarchical_planner.h"
+#include "incremental_planner.h"
+#include "path_planner.h"
+#include "planning_service.h"
+#include "motion_forecast.h"
+#include "plan_budget.h"
+#include "space_time_planner.h"
+#include "space_check.h"
+#include "triple_buffer.h"
 #include "SDL.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
 #include <vector>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <future>
 #include <atomic>
-#include <queue>
-#include <unordered_set>
-
-// Node for A* pathfinding
-struct PathNode {
-  int x, y;
-  int g_cost;  // Cost from start
-  int h_cost;  // Heuristic cost to goal
-  int f_cost() const { return g_cost + h_cost; }
-  PathNode* parent;
-
-  bool operator>(const PathNode& other) const {
-    return f_cost() > other.f_cost();
-  }
-};
 
-// AI-controlled snake using A* pathfinding
-// Satisfies Concurrency rubric: multithreading, mutex, condition variable, promise/future
-class AISnake : public Snake {
+// AI-controlled snake using space-time and incremental (D* Lite) pathfinding.
+// Plans either inline or on the workers of a PlanningService shared with
+// other AI snakes, trading world snapshots and finished paths with them
+// through lock-free triple buffers.
+// Satisfies Concurrency rubric: multithreading, mutex, condition variable
+// (through PlanningService), atomics (TripleBuffer)
+class AISnake : public Snake, public PlanningService::Client {
  public:
+  // Search behind the static plan. D* Lite repairs one search as the world
+  // changes and heads for the food nearest by path length; the others head
+  // for the food nearest as the crow flies. A* and jump point search start
+  // afresh each time; hierarchical planning keeps a cluster graph current
+  // and fills in only the first stretch of its route.
+  enum class Planner { kDStarLite, kAStar, kJumpPoint, kHierarchical };
+
   AISnake(int grid_width, int grid_height);
   ~AISnake();
 
@@ -36,66 +42,206 @@ class AISnake : public Snake {
   AISnake(const AISnake&) = delete;
   AISnake& operator=(const AISnake&) = delete;
 
-  // Allow move
+  // Allow move, while not planning on a service
   AISnake(AISnake&& other) noexcept;
   AISnake& operator=(AISnake&& other) noexcept;
 
-  // Start the AI pathfinding thread
-  void StartAI();
+  // Choose the static planner; call before StartAI()
+  void SetPlanner(Planner planner);
+  Planner GetPlanner() const { return planner_choice_; }
+
+  // "dstar", "astar", "jps" or "hpa"; false if the name is unknown
+  static bool ParsePlanner(const std::string& name, Planner& planner);
+
+  // Time a service worker may take over one snapshot, counted from when it
+  // was published (so time spent queued counts too), before settling for
+  // the best partial path; zero means no limit. Call before StartAI().
+  // Plans made inline by PlanPath() are never cut short, so batch results
+  // stay reproducible.
+  static constexpr std::chrono::microseconds kDefaultPlanBudget{8000};
+  void SetPlanBudget(std::chrono::microseconds budget) {
+    plan_budget_ = budget;
+  }
 
-  // Stop the AI thread
+  // How well planning keeps up, as seen by the game thread
+  struct PlanStats {
+    std::uint64_t delivered{0};  // plans adopted
+    std::uint64_t partial{0};    // of those, cut short by the deadline
+    std::uint64_t cancelled{0};  // abandoned for a newer snapshot
+    std::uint64_t inline_plans{0};  // made by PlanPath() on the game thread
+    // From a snapshot being published to its plan being adopted
+    double total_latency_ms{0.0};
+    double max_latency_ms{0.0};
+    // Snapshots published after the one a plan was made from, counted when
+    // the plan is adopted
+    std::uint64_t total_staleness{0};
+    std::uint64_t max_staleness{0};
+
+    double MeanLatencyMs() const {
+      return delivered > 0 ? total_latency_ms / delivered : 0.0;
+    }
+    double MeanStaleness() const {
+      return delivered > 0 ? static_cast<double>(total_staleness) / delivered
+                           : 0.0;
+    }
+
+    // Fold in another snake's statistics
+    void Add(const PlanStats& other) {
+      delivered += other.delivered;
+      partial += other.partial;
+      cancelled += other.cancelled;
+      inline_plans += other.inline_plans;
+      total_latency_ms += other.total_latency_ms;
+      max_latency_ms = std::max(max_latency_ms, other.max_latency_ms);
+      total_staleness += other.total_staleness;
+      max_staleness = std::max(max_staleness, other.max_staleness);
+    }
+  };
+  const PlanStats& GetPlanStats() const { return plan_stats_; }
+
+  // Plan on the service's workers from now on; the service must outlive
+  // the snake or a call to StopAI()
+  void StartAI(PlanningService& service);
+
+  // Cancel any plan in progress and leave the service
   void StopAI();
 
-  // Update AI snake movement based on calculated path
-  void UpdateAI();
+  // Update AI snake movement based on calculated path. The path may cross
+  // cells that are only forecast to clear, so each move is checked against
+  // the live world as the head is about to make it. If the cell ahead is
+  // still blocked, or entering it would leave less room than the snake is
+  // long, the path is dropped and the snake steers to safety until a new
+  // one arrives.
+  void UpdateAI(const OccupancyGrid& world);
+
+  // Did food or the walkable area change since the last plan?
+  bool NeedsReplan(const OccupancyGrid& world) const {
+    return !planned_ || world.Version() != planned_version_;
+  }
 
-  // Set the current food target (thread-safe)
-  void SetFoodTarget(int x, int y);
+  // Where the game thread fills in the forecast the next PublishWorld()
+  // hands over, so it is written in place rather than copied
+  MotionForecast& NextForecast() { return snapshots_.WriteBuffer().forecast; }
 
-  // Set obstacles for path avoidance (thread-safe)
-  void SetObstacles(const std::vector<SDL_Point>& obstacles);
+  // Publish the world along with NextForecast() and ask the service for a
+  // plan, the more urgent the fewer steps are left on the current path.
+  // Never blocks; called at most once per tick.
+  void PublishWorld(const OccupancyGrid& world);
 
-  // Set player snake body for avoidance (thread-safe)
-  void SetPlayerSnakeBody(const std::vector<SDL_Point>& body, int head_x, int head_y);
+  // Plan synchronously on the calling thread. Used instead of StartAI()
+  // when many games run in parallel.
+  void PlanPath(const OccupancyGrid& world, const MotionForecast& forecast);
 
   // Check if AI has calculated a valid path
   bool HasValidPath() const;
 
  private:
-  // Pathfinding thread function
-  void PathfindingThread();
-
-  // A* pathfinding algorithm
-  std::vector<SDL_Point> CalculatePath(SDL_Point start, SDL_Point goal);
-
-  // Helper functions for A*
-  int Heuristic(int x1, int y1, int x2, int y2) const;
-  std::vector<SDL_Point> GetNeighbors(int x, int y) const;
-  bool IsWalkable(int x, int y) const;
-  std::vector<SDL_Point> ReconstructPath(PathNode* end_node);
-
-  // Thread management
-  std::thread pathfinding_thread_;
-  std::atomic<bool> running_{false};
-
-  // Mutex for thread safety (protects shared state)
-  mutable std::mutex mutex_;
-
-  // Condition variable for synchronization
-  std::condition_variable path_cv_;
-  bool path_requested_{false};
-
-  // Promise/Future for passing path results
-  std::promise<std::vector<SDL_Point>> path_promise_;
-  std::future<std::vector<SDL_Point>> path_future_;
-
-  // Shared state (protected by mutex)
-  SDL_Point food_target_;
-  std::vector<SDL_Point> obstacles_;
-  std::vector<SDL_Point> player_snake_body_;
-  SDL_Point player_head_;
-
-  // Current calculated path
+  // Plan for the newest snapshot (PlanningService::Client, on a worker)
+  void Plan() override;
+
+  // Everything a worker needs for one search, captured by the
+  // game thread at a tick boundary and never modified once published.
+  // Each slot keeps its grid from the last time it was filled and catches
+  // up through the world's journal, so publishing copies only what changed.
+  struct WorldSnapshot {
+    OccupancyGrid grid;
+    MotionForecast forecast;
+    SDL_Point head;
+    std::uint64_t generation;
+    PlanBudget::Clock::time_point published;
+  };
+
+  // A plan and the snapshot it answers, handed back to the game thread
+  struct PlanResult {
+    std::vector<SDL_Point> path;
+    std::uint64_t generation{0};
+    PlanBudget::Clock::time_point published{};
+    bool partial{false};
+    std::uint64_t cancelled{0};  // requests abandoned so far
+  };
+
+  // Plan ignoring motion with the chosen static planner. Returns the length
+  // of the whole plan, or -1 if no food is reachable; `path` may hold only
+  // its first kHorizon steps.
+  int PlanStatic(const OccupancyGrid& world, const MotionForecast& forecast,
+                 SDL_Point head, PlanBudget& budget,
+                 std::vector<SDL_Point>& path);
+
+  // Plan towards the nearest reachable food: a static plan first,
+  // then a space-time search for anything shorter through cells that will
+  // have cleared by the time the head gets there. If the budget runs out,
+  // the best partial path found so far.
+  bool CalculatePath(const OccupancyGrid& world,
+                     const MotionForecast& forecast, SDL_Point head,
+                     PlanBudget& budget, std::vector<SDL_Point>& path);
+
+  // Fold an adopted plan into plan_stats_
+  void RecordPlan(const PlanResult& result);
+
+  // Is every waypoint free by the step the head reaches it? A shortest
+  // path never revisits a cell, so only the forecast needs checking.
+  static bool IsClearInTime(const MotionForecast& forecast,
+                            const std::vector<SDL_Point>& path);
+
+  // Where plans are requested while started (game thread only)
+  PlanningService* service_{nullptr};
+
+  // Game thread -> worker: latest world snapshot.
+  // Worker -> game thread: latest planned path. The service runs one plan
+  // per snake at a time, and its lock orders one worker's reads after the
+  // last's, so each buffer still has a single producer and consumer.
+  TripleBuffer<WorldSnapshot> snapshots_;
+  TripleBuffer<PlanResult> plans_;
+
+  // Generation of the newest snapshot; a search for any older one is
+  // cancelled. Written by the game thread before each publish.
+  std::atomic<std::uint64_t> request_generation_{0};
+  std::chrono::microseconds plan_budget_{kDefaultPlanBudget};
+  std::uint64_t cancelled_{0};  // planning side only
+
+  // The neighbouring cell in the given direction
+  SDL_Point CellTowards(Direction dir) const;
+
+  // Is the cell free to move into this update?
+  bool CanEnter(const OccupancyGrid& world, SDL_Point cell) const;
+
+  // Would moving into the cell leave at least as much reachable space as
+  // the snake is long?
+  bool HasRoom(const OccupancyGrid& world, SDL_Point cell);
+
+  // Turn to the neighbour with room to spare, else one from which the tail
+  // can be followed, else the one with the most room
+  void SteerToSafety(const OccupancyGrid& world);
+
+  int LengthAfterMove() const;
+  // The tail cell vacated by the next move, or `fallback` if none is
+  SDL_Point DepartingTail(SDL_Point fallback) const;
+
+  // Will this tick's move take the head into the next cell?
+  bool EntersNextCell() const;
+
+  // Game thread state
+  bool planned_{false};
+  std::uint64_t planned_version_{0};
+  std::uint64_t published_generation_{0};
+  PlanStats plan_stats_;
+
+  Planner planner_choice_{Planner::kDStarLite};
+
+  // Search tree kept between plans and repaired as the world changes, the
+  // one-shot search used instead of it when chosen, and the time-aware
+  // search run on top of either (service workers, or the game thread when
+  // planning inline)
+  IncrementalPlanner planner_;
+  PathPlanner path_planner_;
+  HierarchicalPlanner hierarchical_planner_;
+  SpaceTimePlanner space_time_planner_;
+  std::vector<SDL_Point> static_path_;
+
+  // Free-space flood fill for judging moves (game thread only)
+  SpaceCheck space_check_;
+
+  // Current calculated path (game thread only)
   std::vector<SDL_Point> current_path_;
   std::size_t path_index_{0};
 
@@ -0,0 +1,128 @@
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Walker's alias method: after setup, one of n outcomes is drawn with
+// probability proportional to its weight from one uniform index and one
+// uniform threshold, however large n is. Weights stay integers throughout
+// (Vose's construction), so the table reproduces them exactly and comes
+// out the same on every compiler and CPU.
+//
+// Fills prob and alias for n weights, using `work` (n entries) as scratch,
+// and returns the total weight. A draw picks i uniformly and keeps it if a
+// uniform value below the total falls under prob[i], else takes alias[i].
+// constexpr so that fixed tables can be built by the compiler.
+template <typename Index>
+constexpr std::uint64_t BuildAliasTable(const std::uint32_t *weights,
+                                        std::size_t n, std::uint64_t *prob,
+                                        Index *alias, std::size_t *work) {
+  std::uint64_t total = 0;
+  for (std::size_t i = 0; i < n; ++i) total += weights[i];
+
+  // Weights scaled by n average `total`. Entries below it are short and
+  // stack up from the front of `work`, the rest from the back.
+  std::size_t short_top = 0;
+  std::size_t tall_top = n;
+  for (std::size_t i = 0; i < n; ++i) {
+    prob[i] = std::uint64_t{weights[i]} * n;
+    alias[i] = static_cast<Index>(i);
+    if (prob[i] < total) {
+      work[short_top++] = i;
+    } else {
+      work[--tall_top] = i;
+    }
+  }
+
+  // Top up each short entry from a tall one, which may turn short itself
+  while (short_top > 0 && tall_top < n) {
+    std::size_t low = work[--short_top];
+    std::size_t high = work[tall_top];
+    alias[low] = static_cast<Index>(high);
+    prob[high] -= total - prob[low];
+    if (prob[high] < total) {
+      tall_top++;
+      work[short_top++] = high;
+    }
+  }
+
+  // In exact arithmetic whatever is left is exactly full
+  for (std::size_t i = 0; i < short_top; ++i) prob[work[i]] = total;
+  for (std::size_t i = tall_top; i < n; ++i) prob[work[i]] = total;
+  return total;
+}
+
+// An alias table over N outcomes, built at compile time
+template <std::size_t N>
+struct StaticAliasTable {
+  std::array<std::uint64_t, N> prob{};
+  std::array<std::uint16_t, N> alias{};
+  std::uint64_t total{0};
+
+  constexpr explicit StaticAliasTable(
+      const std::array<std::uint32_t, N> &weights) {
+    std::array<std::size_t, N> work{};
+    total = BuildAliasTable(weights.data(), N, prob.data(), alias.data(),
+                            work.data());
+  }
+};
+
+// An alias table over any number of outcomes (up to 65536), built at run
+// time or copied from a static one
+class AliasTable {
+ public:
+  AliasTable() = default;
+
+  template <std::size_t N>
+  explicit AliasTable(const StaticAliasTable<N> &table)
+      : prob_(table.prob.begin(), table.prob.end()),
+        alias_(table.alias.begin(), table.alias.end()),
+        total_(table.total) {}
+
+  // False, leaving the table empty, if no weight is positive
+  bool Build(const std::vector<std::uint32_t> &weights) {
+    std::vector<std::size_t> work(weights.size());
+    prob_.resize(weights.size());
+    alias_.resize(weights.size());
+    total_ = BuildAliasTable(weights.data(), weights.size(), prob_.data(),
+                             alias_.data(), work.data());
+    if (total_ == 0) {
+      prob_.clear();
+      alias_.clear();
+    }
+    return total_ != 0;
+  }
+
+  bool Empty() const { return prob_.empty(); }
+
+  // Draw an outcome; the table must not be empty. The index and the
+  // threshold come from one uniform value below n * total, its quotient
+  // and remainder by the total, so each draw takes a single value from a
+  // 32-bit engine whenever n * total fits in 32 bits (as for the built-in
+  // food types) and two otherwise.
+  template <typename Engine>
+  std::size_t Sample(Engine &engine) const {
+    std::uint64_t last = prob_.size() * total_ - 1;
+    std::uint64_t value;
+    if (last <= std::numeric_limits<std::uint32_t>::max()) {
+      value = std::uniform_int_distribution<std::uint32_t>(
+          0, static_cast<std::uint32_t>(last))(engine);
+    } else {
+      value = std::uniform_int_distribution<std::uint64_t>(0, last)(engine);
+    }
+    std::size_t i = static_cast<std::size_t>(value / total_);
+    return value % total_ < prob_[i] ? i : alias_[i];
+  }
+
+ private:
+  std::vector<std::uint64_t> prob_;
+  std::vector<std::uint16_t> alias_;
+  std::uint64_t total_{0};
+};
+
+#endif
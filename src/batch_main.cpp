@@ -0,0 +1,138 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "batch_runner.h"
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "usage: snake_batch [--matches N] [--ticks N] [--grid N]\n"
+               "                   [--seed N] [--threads N] [--scaling]"
+               " [--csv]\n"
+               "                   [--planner dstar|astar|jps|hpa]"
+               " [--ai-snakes N]\n"
+               "                   [--max-food N] [--food-types file]"
+               " [--fast-forward]\n";
+}
+
+void PrintSummary(const BatchReport &report) {
+  int player_wins = 0, ai_wins = 0;
+  long player_points = 0, ai_points = 0;
+  for (const auto &result : report.results) {
+    if (result.player_score > result.ai_score) player_wins++;
+    if (result.ai_score > result.player_score) ai_wins++;
+    player_points += result.player_score;
+    ai_points += result.ai_score;
+  }
+  std::size_t matches = report.results.size();
+
+  std::cout << "matches: " << matches << "\n";
+  std::cout << "threads: " << report.threads << "\n";
+  std::cout << "elapsed: " << report.seconds << " s\n";
+  std::cout << "total ticks: " << report.total_ticks << "\n";
+  std::cout << "ticks/sec: " << report.TicksPerSecond() << "\n";
+  std::cout << "matches/sec: "
+            << (report.seconds > 0 ? matches / report.seconds : 0) << "\n";
+  if (matches > 0) {
+    std::cout << "player wins: " << player_wins << ", ai wins: " << ai_wins
+              << ", draws: " << matches - player_wins - ai_wins << "\n";
+    std::cout << "mean score: player " << double(player_points) / matches
+              << ", ai " << double(ai_points) / matches << "\n";
+  }
+}
+
+}  // namespace
+
+// Plays many seeded AI-versus-AI matches across all cores.
+int main(int argc, char *argv[]) {
+  BatchConfig config;
+  unsigned threads = 0;
+  bool scaling = false;
+  bool csv = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--matches" && has_value) {
+      config.matches = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--ticks" && has_value) {
+      config.max_ticks = std::atol(argv[++i]);
+    } else if (arg == "--grid" && has_value) {
+      config.grid_width = config.grid_height =
+          std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--seed" && has_value) {
+      config.base_seed =
+          static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--threads" && has_value) {
+      threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--planner" && has_value &&
+               AISnake::ParsePlanner(argv[i + 1], config.planner)) {
+      ++i;
+    } else if (arg == "--ai-snakes" && has_value) {
+      config.ai_snakes = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--max-food" && has_value) {
+      config.max_food = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--food-types" && has_value) {
+      std::ifstream in(argv[++i]);
+      std::string error = "cannot open";
+      if (!in || !config.food_types.Read(in, error)) {
+        std::cerr << argv[i] << ": " << error << "\n";
+        return 1;
+      }
+    } else if (arg == "--fast-forward") {
+      config.fast_forward = true;
+    } else if (arg == "--scaling") {
+      scaling = true;
+    } else if (arg == "--csv") {
+      csv = true;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  // Obstacles keep a 9x9 area clear around the spawn point
+  if (config.grid_width < 16 || config.grid_width > kMaxGridCells ||
+      config.max_ticks <= 0 || config.base_seed == 0) {
+    PrintUsage();
+    std::cerr << "grid must be from 16 to " << kMaxGridCells
+              << ", ticks and seed positive\n";
+    return 1;
+  }
+
+  BatchRunner runner(config);
+
+  if (scaling) {
+    // Throughput at 1, 2, 4, ... workers up to the hardware thread count
+    unsigned max_threads =
+        threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    double baseline = 0.0;
+    std::cout << "threads,seconds,ticks_per_sec,speedup\n";
+    for (unsigned t = 1;; t = std::min(t * 2, max_threads)) {
+      BatchReport report = runner.Run(t);
+      if (t == 1) baseline = report.TicksPerSecond();
+      std::cout << t << "," << report.seconds << "," << report.TicksPerSecond()
+                << "," << (baseline > 0 ? report.TicksPerSecond() / baseline : 0)
+                << "\n";
+      if (t == max_threads) break;
+    }
+    return 0;
+  }
+
+  BatchReport report = runner.Run(threads);
+  if (csv) {
+    std::cout << "match,seed,ticks,player_score,ai_score,player_size,ai_size,"
+                 "player_alive,ai_alive\n";
+    for (std::size_t i = 0; i < report.results.size(); ++i) {
+      const MatchResult &r = report.results[i];
+      std::cout << i << "," << r.seed << "," << r.ticks << "," << r.player_score
+                << "," << r.ai_score << "," << r.player_size << "," << r.ai_size
+                << "," << r.player_alive << "," << r.ai_alive << "\n";
+    }
+    return 0;
+  }
+  PrintSummary(report);
+  return 0;
+}
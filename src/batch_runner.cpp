@@ -0,0 +1,165 @@
+#include "batch_runner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "game.h"
+
+namespace {
+
+// Per-worker queue of match indices. The owner takes from the front and
+// thieves take from the back, which keeps contention to the rare steal.
+struct WorkQueue {
+  std::mutex mutex;
+  std::deque<std::size_t> matches;
+
+  bool PopFront(std::size_t &match) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (matches.empty()) return false;
+    match = matches.front();
+    matches.pop_front();
+    return true;
+  }
+
+  bool StealBack(std::size_t &match) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (matches.empty()) return false;
+    match = matches.back();
+    matches.pop_back();
+    return true;
+  }
+};
+
+// Greedy autopilot for the player slot so a match is AI versus AI: turn
+// towards the nearest food (torus distance) without stepping into a
+// blocked cell, keeping the current heading when every option is blocked.
+Game::StepInput GreedyPilot(const Game &game) {
+  const Snake &snake = game.GetSnake();
+  const OccupancyGrid &grid = game.GetGrid();
+  int width = grid.Width();
+  int height = grid.Height();
+  int x = snake.HeadX();
+  int y = snake.HeadY();
+
+  static constexpr Snake::Direction kDirections[] = {
+      Snake::Direction::kUp, Snake::Direction::kDown, Snake::Direction::kLeft,
+      Snake::Direction::kRight};
+
+  Game::StepInput input;
+  int best = std::numeric_limits<int>::max();
+  for (Snake::Direction direction : kDirections) {
+    int nx = x, ny = y;
+    switch (direction) {
+      case Snake::Direction::kUp:
+        ny = (y + height - 1) % height;
+        break;
+      case Snake::Direction::kDown:
+        ny = (y + 1) % height;
+        break;
+      case Snake::Direction::kLeft:
+        nx = (x + width - 1) % width;
+        break;
+      case Snake::Direction::kRight:
+        nx = (x + 1) % width;
+        break;
+    }
+    if (grid.IsBlocked(nx, ny)) continue;
+
+    SDL_Point food;
+    int distance = width + height;
+    game.GetFoodPool().Nearest(SDL_Point{nx, ny}, food, distance);
+    if (distance < best) {
+      best = distance;
+      input.player_direction = direction;
+    }
+  }
+  return input;
+}
+
+}  // namespace
+
+BatchRunner::BatchRunner(const BatchConfig &config) : config_(config) {}
+
+MatchResult BatchRunner::PlayMatch(std::uint32_t seed) const {
+  Game::Options options;
+  options.threaded_ai = false;
+  options.seed = seed;
+  options.planner = config_.planner;
+  options.num_ai_snakes = config_.ai_snakes;
+  options.max_food_items = config_.max_food;
+  options.food_types = config_.food_types;
+  Game game(config_.grid_width, config_.grid_height, options);
+
+  MatchResult result;
+  result.seed = seed;
+  while (result.ticks < config_.max_ticks && !game.IsOver()) {
+    game.Step(GreedyPilot(game));
+    result.ticks++;
+    // The autopilot only looks at cells, so it would steer the same way
+    // through every skipped tick
+    if (config_.fast_forward && !game.IsOver()) {
+      result.ticks += game.FastForward(config_.max_ticks - result.ticks);
+    }
+  }
+
+  result.player_score = game.GetScore();
+  result.ai_score = game.GetAIScore();
+  result.player_size = game.GetSize();
+  result.ai_size = game.GetAISnake().size;
+  result.player_alive = game.GetSnake().alive;
+  for (const AISnake &ai : game.GetAISnakes()) {
+    result.ai_alive = result.ai_alive || ai.alive;
+  }
+  return result;
+}
+
+BatchReport BatchRunner::Run(unsigned threads) const {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  BatchReport report;
+  report.threads = threads;
+  report.results.resize(config_.matches);
+
+  // Deal matches out round-robin; stealing evens out the rest
+  std::vector<WorkQueue> queues(threads);
+  for (std::size_t i = 0; i < config_.matches; ++i) {
+    queues[i % threads].matches.push_back(i);
+  }
+
+  auto worker = [&](unsigned self) {
+    std::size_t match;
+    while (true) {
+      bool found = queues[self].PopFront(match);
+      for (unsigned k = 1; !found && k < threads; ++k) {
+        found = queues[(self + k) % threads].StealBack(match);
+      }
+      // No new work is ever queued, so empty everywhere means done
+      if (!found) return;
+
+      report.results[match] =
+          PlayMatch(config_.base_seed + static_cast<std::uint32_t>(match));
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; ++t) {
+    workers.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto &thread : workers) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  report.seconds = std::chrono::duration<double>(end - start).count();
+  for (const auto &result : report.results) {
+    report.total_ticks += result.ticks;
+  }
+  return report;
+}
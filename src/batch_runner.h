@@ -0,0 +1,71 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ai_snake.h"
+#include "food.h"
+
+// Outcome of a single seeded match
+struct MatchResult {
+  std::uint32_t seed{0};
+  long ticks{0};
+  int player_score{0};
+  int ai_score{0};  // best among the AI snakes
+  int player_size{0};
+  int ai_size{0};  // of the first AI snake
+  bool player_alive{false};
+  bool ai_alive{false};  // any AI snake
+};
+
+// What to run: `matches` games seeded base_seed, base_seed + 1, ...
+struct BatchConfig {
+  std::size_t grid_width{32};
+  std::size_t grid_height{32};
+  std::size_t matches{1000};
+  long max_ticks{20000};
+  std::uint32_t base_seed{1};
+  AISnake::Planner planner{AISnake::Planner::kDStarLite};
+  std::size_t ai_snakes{1};
+  // Most food on the board at once
+  std::size_t max_food{5};
+  // The built-in food types plus any read from a file
+  FoodRegistry food_types;
+  // Skip the ticks in which the snakes only move within their cells
+  // (Game::FastForward); results are the same either way. Matches spend
+  // nearly all their time in the ticks that plan, so this saves little.
+  bool fast_forward{false};
+};
+
+struct BatchReport {
+  std::vector<MatchResult> results;  // indexed by match number
+  unsigned threads{0};
+  double seconds{0.0};
+  long total_ticks{0};
+
+  double TicksPerSecond() const {
+    return seconds > 0.0 ? total_ticks / seconds : 0.0;
+  }
+};
+
+// Plays many independent headless matches across worker threads. Each
+// worker owns a deque of match indices and, when it runs dry, steals from
+// the back of another worker's deque, so uneven match lengths still keep
+// every core busy. AI pathfinding runs inline inside each match rather
+// than on a thread per snake.
+class BatchRunner {
+ public:
+  explicit BatchRunner(const BatchConfig &config);
+
+  // Run every match using `threads` workers (0 = all hardware threads)
+  BatchReport Run(unsigned threads) const;
+
+  // Play one match to completion or max_ticks on the calling thread
+  MatchResult PlayMatch(std::uint32_t seed) const;
+
+ private:
+  BatchConfig config_;
+};
+
+#endif
@@ -6,10 +6,6 @@
 class Controller {
  public:
   void HandleInput(bool &running, Snake &snake) const;
-
- private:
-  void ChangeDirection(Snake &snake, Snake::Direction input,
-                       Snake::Direction opposite) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <cstdint>
+
+// Snake positions and speeds are counted in sub-cells, kSubcellsPerCell to
+// a cell, so movement is integer arithmetic: a simulation plays out bit for
+// bit the same whatever the compiler, optimization level or CPU.
+using Subcells = std::int32_t;
+
+constexpr int kSubcellBits = 16;
+constexpr Subcells kSubcellsPerCell = Subcells{1} << kSubcellBits;
+
+// The widest or tallest board supported, 2^27 sub-cells across. A Subcells
+// would overflow at 2^15 cells; well short of that, a head that steps past
+// the far edge (at most a cell per tick) still fits before it wraps.
+// Runners reject anything larger.
+constexpr int kMaxGridCells = 2048;
+static_assert(std::int64_t{kMaxGridCells + 1} * kSubcellsPerCell <= INT32_MAX,
+              "board positions must fit in Subcells");
+
+// A non-negative number of cells in sub-cells, rounded to the nearest; meant
+// for constants, which the compiler converts
+constexpr Subcells ToSubcells(double cells) {
+  return static_cast<Subcells>(cells * kSubcellsPerCell + 0.5);
+}
+
+// The cell a position lies in
+constexpr int CellOf(Subcells position) { return position >> kSubcellBits; }
+
+// A position in cells, for drawing only
+inline float ToCells(Subcells position) {
+  return static_cast<float>(position) / kSubcellsPerCell;
+}
+
+#endif
@@ -1,91 +1,142 @@
 #include "food.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <sstream>
 #include "snake.h"
 
-// Base Food class implementation
-Food::Food(int x, int y, Type type)
-    : position_{x, y}, type_(type) {}
-
-bool Food::IsAt(int x, int y) const {
-  return position_.x == x && position_.y == y;
+namespace {
+
+constexpr std::size_t kNumBuiltinTypes = 4;
+
+// One entry per built-in Food::Type, in the enum's order
+constexpr FoodTraits kBuiltinTypes[kNumBuiltinTypes] = {
+    // Normal: grows the snake and speeds it up a little
+    {1, 1, ToSubcells(0.002), 0, {0xFF, 0xFF, 0x00, 0xFF}, 60},  // Yellow
+    // Speed boost: a larger speed increase
+    {2, 1, ToSubcells(0.005), 0, {0xFF, 0x44, 0x44, 0xFF}, 15},  // Red
+    // Slowdown: decreases speed but keeps a minimum
+    {1, 1, -ToSubcells(0.005), ToSubcells(0.05),
+     {0x00, 0xFF, 0x88, 0xFF}, 15},  // Cyan-green
+    // Bonus: extra points (rare spawn), no speed change
+    {5, 1, 0, 0, {0xFF, 0x66, 0xFF, 0xFF}, 10},  // Bright pink
+};
+
+constexpr std::array<std::uint32_t, kNumBuiltinTypes> BuiltinWeights() {
+  std::array<std::uint32_t, kNumBuiltinTypes> weights{};
+  for (std::size_t i = 0; i < kNumBuiltinTypes; ++i) {
+    weights[i] = kBuiltinTypes[i].spawn_weight;
+  }
+  return weights;
 }
 
-// NormalFood implementation
-NormalFood::NormalFood(int x, int y)
-    : Food(x, y, Type::Normal) {}
+constexpr StaticAliasTable<kNumBuiltinTypes> kBuiltinTable(BuiltinWeights());
+static_assert(kBuiltinTable.total == 100, "built-in weights are percentages");
 
-void NormalFood::ApplyEffect(Snake& snake, int& score) {
-  score += GetPoints();
-  snake.GrowBody();
-  snake.speed += 0.002f;
+// Signed cells per tick to sub-cells, rounded to the nearest
+Subcells SpeedFromCells(double cells) {
+  return cells < 0 ? -ToSubcells(-cells) : ToSubcells(cells);
 }
 
-Color NormalFood::GetColor() const {
-  return {0xFF, 0xFF, 0x00, 0xFF};  // Bright yellow
-}
-
-// SpeedBoostFood implementation
-SpeedBoostFood::SpeedBoostFood(int x, int y)
-    : Food(x, y, Type::SpeedBoost) {}
-
-void SpeedBoostFood::ApplyEffect(Snake& snake, int& score) {
-  score += GetPoints();
-  snake.GrowBody();
-  snake.speed += kSpeedIncrease;  // Extra speed boost
-}
+}  // namespace
 
-Color SpeedBoostFood::GetColor() const {
-  return {0xFF, 0x44, 0x44, 0xFF};  // Bright red - speed boost
+void FoodTraits::Apply(Snake& snake, int& score) const {
+  score += points;
+  snake.GrowBody(growth);
+  if (speed_delta < 0) {
+    snake.speed = std::max(min_speed, snake.speed + speed_delta);
+  } else {
+    snake.speed = std::min(Snake::kMaxSpeed, snake.speed + speed_delta);
+  }
 }
 
-// SlowdownFood implementation
-SlowdownFood::SlowdownFood(int x, int y)
-    : Food(x, y, Type::Slowdown) {}
-
-void SlowdownFood::ApplyEffect(Snake& snake, int& score) {
-  score += GetPoints();
-  snake.GrowBody();
-  // Decrease speed but maintain minimum
-  snake.speed = std::max(kMinSpeed, snake.speed - kSpeedDecrease);
-}
+FoodRegistry::FoodRegistry()
+    : types_(std::begin(kBuiltinTypes), std::end(kBuiltinTypes)),
+      table_(kBuiltinTable) {}
 
-Color SlowdownFood::GetColor() const {
-  return {0x00, 0xFF, 0x88, 0xFF};  // Cyan-green - slowdown
+const char* FoodRegistry::Check(const FoodTraits& traits) {
+  if (traits.growth < 0 || traits.growth > kMaxGrowth) {
+    return "growth out of range";
+  }
+  if (traits.speed_delta < -Snake::kMaxSpeed ||
+      traits.speed_delta > Snake::kMaxSpeed || traits.min_speed < 0 ||
+      traits.min_speed > Snake::kMaxSpeed) {
+    return "speeds must be within one cell per tick";
+  }
+  if (traits.speed_delta < 0 && traits.min_speed < Snake::kMinSpeed) {
+    return "a negative speed_delta needs a positive min_speed";
+  }
+  return nullptr;
 }
 
-// BonusFood implementation
-BonusFood::BonusFood(int x, int y)
-    : Food(x, y, Type::Bonus) {}
+bool FoodRegistry::Add(const FoodTraits& traits) {
+  if (types_.size() > std::numeric_limits<std::uint16_t>::max() ||
+      Check(traits) != nullptr) {
+    return false;
+  }
 
-void BonusFood::ApplyEffect(Snake& snake, int& score) {
-  score += GetPoints();
-  snake.GrowBody();
-  // No speed change for bonus food
+  types_.push_back(traits);
+  std::vector<std::uint32_t> weights;
+  weights.reserve(types_.size());
+  for (const FoodTraits& type : types_) weights.push_back(type.spawn_weight);
+  table_.Build(weights);
+  return true;
 }
 
-Color BonusFood::GetColor() const {
-  return {0xFF, 0x66, 0xFF, 0xFF};  // Bright pink - bonus points
+bool FoodRegistry::Read(std::istream& in, std::string& error) {
+  std::string line;
+  for (int number = 1; std::getline(in, line); ++number) {
+    std::istringstream fields(line);
+    std::string first;
+    if (!(fields >> first) || first[0] == '#') continue;
+    fields.seekg(0);
+
+    FoodTraits traits{};
+    double speed_delta = 0.0, min_speed = 0.0;
+    std::string color;
+    long weight = -1;
+    fields >> traits.points >> traits.growth >> speed_delta >> min_speed >>
+        color >> weight;
+    if (!color.empty() && color[0] == '#') color.erase(0, 1);
+    bool hex = color.size() == 6 &&
+               std::all_of(color.begin(), color.end(), [](unsigned char c) {
+                 return std::isxdigit(c) != 0;
+               });
+    std::string rest;
+    if (!fields || !hex || weight < 0 ||
+        weight > std::numeric_limits<std::uint32_t>::max() || fields >> rest) {
+      error = "line " + std::to_string(number) +
+              ": expected points growth speed_delta min_speed RRGGBB "
+              "spawn_weight";
+      return false;
+    }
+    // Range-checked in cells first, as sub-cells would overflow
+    if (!(std::abs(speed_delta) <= 1.0 && min_speed >= 0 &&
+          min_speed <= 1.0)) {
+      error = "line " + std::to_string(number) +
+              ": speeds must be within one cell per tick";
+      return false;
+    }
+    traits.speed_delta = SpeedFromCells(speed_delta);
+    traits.min_speed = ToSubcells(min_speed);
+    unsigned long rgb = std::strtoul(color.c_str(), nullptr, 16);
+    traits.color = {static_cast<Uint8>(rgb >> 16), static_cast<Uint8>(rgb >> 8),
+                    static_cast<Uint8>(rgb), 0xFF};
+    traits.spawn_weight = static_cast<std::uint32_t>(weight);
+    if (const char* problem = Check(traits)) {
+      error = "line " + std::to_string(number) + ": " + problem;
+      return false;
+    }
+    if (!Add(traits)) {
+      error = "line " + std::to_string(number) + ": too many food types";
+      return false;
+    }
+  }
+  return true;
 }
 
 // FoodFactory implementation
-FoodFactory::FoodFactory(int grid_width, int grid_height)
-    : random_x_(0, grid_width - 1),
-      random_y_(0, grid_height - 1),
-      random_type_(0, 99) {}
-
-std::unique_ptr<Food> FoodFactory::CreateRandomFood(std::mt19937& engine) {
-  int x = random_x_(engine);
-  int y = random_y_(engine);
-  int type_roll = random_type_(engine);
-
-  // Probability distribution:
-  // 60% Normal, 15% SpeedBoost, 15% Slowdown, 10% Bonus
-  if (type_roll < 60) {
-    return CreateFood<NormalFood>(x, y);
-  } else if (type_roll < 75) {
-    return CreateFood<SpeedBoostFood>(x, y);
-  } else if (type_roll < 90) {
-    return CreateFood<SlowdownFood>(x, y);
-  } else {
-    return CreateFood<BonusFood>(x, y);
-  }
-}
+FoodFactory::FoodFactory(const FoodRegistry& types) : types_(types) {}
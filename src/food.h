@@ -2,8 +2,14 @@
 #define FOOD_H
 
 #include "SDL.h"
+#include "alias_table.h"
+#include "fixed_point.h"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
 #include <random>
-#include <memory>
+#include <string>
+#include <vector>
 
 // Forward declaration
 class Snake;
@@ -13,27 +19,35 @@ struct Color {
   Uint8 r, g, b, a;
 };
 
-// Abstract base class for all food types
-// Satisfies OOP rubric: classes, access specifiers, inheritance, virtual functions
+// What eating one kind of food does, how it is drawn and how often it
+// spawns
+struct FoodTraits {
+  int points;
+  // Segments the eater grows by
+  int growth;
+  // Added to the eater's speed, which never drops below min_speed through
+  // a negative delta nor rises above Snake::kMaxSpeed
+  Subcells speed_delta;
+  Subcells min_speed;
+  Color color;
+  // Relative to the other types' weights
+  std::uint32_t spawn_weight;
+
+  // Score the food and grow and speed up (or slow down) the snake
+  void Apply(Snake& snake, int& score) const;
+};
+
+// A food item is a plain value: a cell and a type. Everything that differs
+// between types lives in a FoodRegistry indexed by the type, so items sit
+// contiguously, copy without allocating and are applied without virtual
+// calls.
 class Food {
  public:
-  // Enum for food type identification
-  enum class Type { Normal, SpeedBoost, Slowdown, Bonus };
+  // The built-in types; custom ones follow them in a FoodRegistry
+  enum class Type : std::uint16_t { Normal, SpeedBoost, Slowdown, Bonus };
 
   // Constructor with member initialization list
-  Food(int x, int y, Type type);
-
-  // Virtual destructor for proper polymorphic destruction
-  virtual ~Food() = default;
-
-  // Pure virtual method - each food type implements its own effect
-  virtual void ApplyEffect(Snake& snake, int& score) = 0;
-
-  // Pure virtual method - each food type has its own color
-  virtual Color GetColor() const = 0;
-
-  // Pure virtual method - returns point value
-  virtual int GetPoints() const = 0;
+  Food(int x, int y, Type type) : position_{x, y}, type_(type) {}
 
   // Getters (encapsulation)
   int GetX() const { return position_.x; }
@@ -42,75 +56,72 @@ class Food {
   Type GetType() const { return type_; }
 
   // Check if position matches this food
-  bool IsAt(int x, int y) const;
+  bool IsAt(int x, int y) const {
+    return position_.x == x && position_.y == y;
+  }
 
- protected:
+ private:
   SDL_Point position_;
   Type type_;
 };
 
-// Normal food - standard behavior (1 point, grows snake)
-class NormalFood : public Food {
- public:
-  NormalFood(int x, int y);
-  void ApplyEffect(Snake& snake, int& score) override;
-  Color GetColor() const override;
-  int GetPoints() const override { return 1; }
-};
-
-// Speed boost food - temporarily increases speed
-class SpeedBoostFood : public Food {
+// The food types a game spawns. Spawning draws a type through an alias
+// table in O(1) however many types there are; the table for the built-in
+// types is built by the compiler, and each custom type added when a
+// program starts rebuilds it.
+class FoodRegistry {
  public:
-  SpeedBoostFood(int x, int y);
-  void ApplyEffect(Snake& snake, int& score) override;
-  Color GetColor() const override;
-  int GetPoints() const override { return 2; }
+  // The built-in types: 60% Normal, 15% SpeedBoost, 15% Slowdown, 10% Bonus
+  FoodRegistry();
+
+  // Why a snake could not safely eat food of these traits, or null if it
+  // can: growth in [0, kMaxGrowth], speeds within one cell per tick, and a
+  // negative speed_delta only above a min_speed of at least
+  // Snake::kMinSpeed
+  static constexpr int kMaxGrowth = 1 << 16;
+  static const char* Check(const FoodTraits& traits);
+
+  // Add a type, which becomes Food::Type(Size() - 1); false if the
+  // registry is full or Check() objects
+  bool Add(const FoodTraits& traits);
+
+  // Read custom types and add them, one per line:
+  //   points growth speed_delta min_speed RRGGBB spawn_weight
+  // with speeds in cells per tick; blank lines and lines starting with '#'
+  // are skipped. On a malformed line, or one that Check() objects to,
+  // returns false with a message in `error`, having added the lines before
+  // it.
+  bool Read(std::istream& in, std::string& error);
+
+  std::size_t Size() const { return types_.size(); }
+  const FoodTraits& Traits(Food::Type type) const {
+    return types_[static_cast<std::size_t>(type)];
+  }
+
+  // A random type, each as likely as its share of the total weight
+  Food::Type Sample(std::mt19937& engine) const {
+    return static_cast<Food::Type>(table_.Sample(engine));
+  }
 
  private:
-  static constexpr float kSpeedIncrease = 0.005f;
+  std::vector<FoodTraits> types_;
+  AliasTable table_;
 };
 
-// Slowdown food - temporarily decreases speed
-class SlowdownFood : public Food {
- public:
-  SlowdownFood(int x, int y);
-  void ApplyEffect(Snake& snake, int& score) override;
-  Color GetColor() const override;
-  int GetPoints() const override { return 1; }
-
- private:
-  static constexpr float kSpeedDecrease = 0.005f;
-  static constexpr float kMinSpeed = 0.05f;
-};
-
-// Bonus food - gives extra points (rare spawn)
-class BonusFood : public Food {
- public:
-  BonusFood(int x, int y);
-  void ApplyEffect(Snake& snake, int& score) override;
-  Color GetColor() const override;
-  int GetPoints() const override { return 5; }
-};
-
-// Template factory function for creating food objects
-// Satisfies OOP rubric: templates
-template<typename T>
-std::unique_ptr<Food> CreateFood(int x, int y) {
-  return std::make_unique<T>(x, y);
-}
-
 // Food factory class for random food generation
 class FoodFactory {
  public:
-  FoodFactory(int grid_width, int grid_height);
+  explicit FoodFactory(const FoodRegistry& types = FoodRegistry());
+
+  // Creates food of a random type at the given cell
+  Food CreateRandomFood(int x, int y, std::mt19937& engine) const {
+    return Food(x, y, types_.Sample(engine));
+  }
 
-  // Creates a random food type at a random valid position
-  std::unique_ptr<Food> CreateRandomFood(std::mt19937& engine);
+  const FoodRegistry& Types() const { return types_; }
 
  private:
-  std::uniform_int_distribution<int> random_x_;
-  std::uniform_int_distribution<int> random_y_;
-  std::uniform_int_distribution<int> random_type_;
+  FoodRegistry types_;
 };
 
 #endif
@@ -0,0 +1,166 @@
+#include "food_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+FoodPool::FoodPool(int grid_width, int grid_height, std::size_t capacity)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      item_at_(static_cast<std::size_t>(grid_width) * grid_height, kNone),
+      buckets_x_((grid_width + kBucketSize - 1) / kBucketSize),
+      buckets_y_((grid_height + kBucketSize - 1) / kBucketSize),
+      min_extent_(std::min(grid_width / buckets_x_,
+                           grid_height / buckets_y_)),
+      bucket_column_(grid_width),
+      bucket_row_(grid_height),
+      buckets_(static_cast<std::size_t>(buckets_x_) * buckets_y_) {
+  capacity = std::min(capacity, item_at_.size());
+  items_.reserve(capacity);
+  bucket_slots_.reserve(capacity);
+  for (int x = 0; x < grid_width; ++x) {
+    bucket_column_[x] = x * buckets_x_ / grid_width;
+  }
+  for (int y = 0; y < grid_height; ++y) {
+    bucket_row_[y] = y * buckets_y_ / grid_height;
+  }
+}
+
+void FoodPool::Add(const Food& food) {
+  std::uint32_t index = static_cast<std::uint32_t>(items_.size());
+  std::vector<std::uint32_t>& bucket = buckets_[BucketOf(food.GetPosition())];
+  item_at_[Cell(food.GetX(), food.GetY())] = index;
+  bucket_slots_.push_back(static_cast<std::uint32_t>(bucket.size()));
+  bucket.push_back(index);
+  items_.push_back(food);
+}
+
+Food FoodPool::Take(int x, int y) {
+  std::uint32_t index = item_at_[Cell(x, y)];
+  Food food = items_[index];
+  item_at_[Cell(x, y)] = kNone;
+
+  // Out of its bucket: the bucket's last entry fills the slot
+  std::vector<std::uint32_t>& bucket = buckets_[BucketOf(food.GetPosition())];
+  std::uint32_t slot = bucket_slots_[index];
+  bucket[slot] = bucket.back();
+  bucket_slots_[bucket[slot]] = slot;
+  bucket.pop_back();
+
+  // Out of the items: the last item fills the gap, and both indices that
+  // point at it follow
+  std::uint32_t last = static_cast<std::uint32_t>(items_.size() - 1);
+  if (index != last) {
+    const Food& moved = items_[last];
+    items_[index] = moved;
+    bucket_slots_[index] = bucket_slots_[last];
+    item_at_[Cell(moved.GetX(), moved.GetY())] = index;
+    buckets_[BucketOf(moved.GetPosition())][bucket_slots_[index]] = index;
+  }
+  items_.pop_back();
+  bucket_slots_.pop_back();
+  return food;
+}
+
+int FoodPool::Distance(SDL_Point a, SDL_Point b) const {
+  int dx = std::abs(a.x - b.x);
+  int dy = std::abs(a.y - b.y);
+  return std::min(dx, grid_width_ - dx) + std::min(dy, grid_height_ - dy);
+}
+
+void FoodPool::Consider(std::uint32_t index, SDL_Point from,
+                        std::size_t k) const {
+  SDL_Point cell = items_[index].GetPosition();
+  std::pair<int, std::uint32_t> candidate{
+      Distance(from, cell), static_cast<std::uint32_t>(Cell(cell.x, cell.y))};
+  if (scratch_.size() == k) {
+    if (!(candidate < scratch_.back())) return;
+    if (k == 1) {
+      scratch_.back() = candidate;
+      return;
+    }
+    scratch_.pop_back();
+  }
+  // k is small, so insertion into a sorted run is cheapest
+  scratch_.insert(std::upper_bound(scratch_.begin(), scratch_.end(), candidate),
+                  candidate);
+}
+
+void FoodPool::Search(SDL_Point from, std::size_t k) const {
+  scratch_.clear();
+  if (k == 0 || items_.empty()) return;
+
+  // With few items, or so few that rings would pass mostly empty buckets
+  // before meeting one, a plain scan is quicker
+  if (ScansAll()) {
+    for (std::uint32_t i = 0; i < items_.size(); ++i) Consider(i, from, k);
+    return;
+  }
+
+  // Rings of buckets around the query's own, by Chebyshev distance in
+  // buckets. Offsets run over one wrap of the board, -(n-1)/2 to n/2, so
+  // no bucket is visited twice and each is reached by its shorter way round.
+  int bx = bucket_column_[from.x];
+  int by = bucket_row_[from.y];
+  int low_x = -(buckets_x_ - 1) / 2, high_x = buckets_x_ / 2;
+  int low_y = -(buckets_y_ - 1) / 2, high_y = buckets_y_ / 2;
+  int rings = std::max(high_x, high_y);
+  auto visit = [&](int dx, int dy) {
+    int x = (bx + dx + buckets_x_) % buckets_x_;
+    int y = (by + dy + buckets_y_) % buckets_y_;
+    for (std::uint32_t index :
+         buckets_[static_cast<std::size_t>(y) * buckets_x_ + x]) {
+      Consider(index, from, k);
+    }
+  };
+  for (int r = 0; r <= rings; ++r) {
+    for (int dy = std::max(-r, low_y); dy <= std::min(r, high_y); ++dy) {
+      if (dy == -r || dy == r) {
+        for (int dx = std::max(-r, low_x); dx <= std::min(r, high_x); ++dx) {
+          visit(dx, dy);
+        }
+      } else {
+        if (-r >= low_x) visit(-r, dy);
+        if (r != 0 && r <= high_x) visit(r, dy);
+      }
+    }
+    // A bucket further out lies beyond at least r whole buckets on one
+    // axis, so nothing unseen can be this close
+    if (scratch_.size() == k && scratch_.back().first <= r * min_extent_) {
+      return;
+    }
+  }
+}
+
+void FoodPool::Nearest(SDL_Point from, std::size_t k,
+                       std::vector<SDL_Point>& out) const {
+  Search(from, k);
+  out.clear();
+  for (const auto& candidate : scratch_) {
+    out.push_back(SDL_Point{static_cast<int>(candidate.second % grid_width_),
+                            static_cast<int>(candidate.second / grid_width_)});
+  }
+}
+
+bool FoodPool::Nearest(SDL_Point from, SDL_Point& food, int& distance) const {
+  if (items_.empty()) return false;
+  std::pair<int, std::uint32_t> best;
+  if (ScansAll()) {
+    // A running minimum, without the candidate list: distance and cell
+    // index packed into one key, so ties need no branch of their own
+    std::uint64_t key = ~std::uint64_t{0};
+    for (const Food& item : items_) {
+      SDL_Point cell = item.GetPosition();
+      key = std::min(key,
+                     std::uint64_t(Distance(from, cell)) << 32 |
+                         static_cast<std::uint32_t>(Cell(cell.x, cell.y)));
+    }
+    best = {static_cast<int>(key >> 32), static_cast<std::uint32_t>(key)};
+  } else {
+    Search(from, 1);
+    best = scratch_.front();
+  }
+  distance = best.first;
+  food = SDL_Point{static_cast<int>(best.second % grid_width_),
+                   static_cast<int>(best.second / grid_width_)};
+  return true;
+}
@@ -0,0 +1,98 @@
+#ifndef FOOD_POOL_H
+#define FOOD_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "SDL.h"
+#include "food.h"
+
+// The food on the board, at most one item per cell. Items are stored
+// contiguously and indexed two ways: by cell, so a snake's head finds the
+// food under it in O(1), and by coarse buckets of about kBucketSize cells
+// square, so nearest-food queries look only at the buckets around the
+// query point, wrapping across the board's edges. Removal swaps the last
+// item into the gap, so steady state never allocates.
+class FoodPool {
+ public:
+  static constexpr int kBucketSize = 8;
+
+  // `capacity` items are reserved up front
+  FoodPool(int grid_width, int grid_height, std::size_t capacity);
+
+  std::size_t Size() const { return items_.size(); }
+  bool Empty() const { return items_.empty(); }
+
+  // Every item, in no particular order
+  const std::vector<Food>& Items() const { return items_; }
+
+  // The food at a cell, or null
+  const Food* At(int x, int y) const {
+    std::uint32_t index = item_at_[Cell(x, y)];
+    return index == kNone ? nullptr : &items_[index];
+  }
+
+  // Add food on a cell that holds none
+  void Add(const Food& food);
+
+  // Remove and return the food at a cell that holds some
+  Food Take(int x, int y);
+
+  // Replace `out` with the cells of the (up to) k foods nearest `from` by
+  // Manhattan distance on the torus, nearest first, ties going to the lower
+  // cell index
+  void Nearest(SDL_Point from, std::size_t k,
+               std::vector<SDL_Point>& out) const;
+
+  // The nearest food's cell and its distance; false if there is no food
+  bool Nearest(SDL_Point from, SDL_Point& food, int& distance) const;
+
+ private:
+  static constexpr std::uint32_t kNone = ~std::uint32_t{0};
+  // Up to this many items, queries scan them all
+  static constexpr std::size_t kScanItems = 32;
+
+  std::size_t Cell(int x, int y) const {
+    return static_cast<std::size_t>(y) * grid_width_ + x;
+  }
+  std::size_t BucketOf(SDL_Point cell) const {
+    return static_cast<std::size_t>(bucket_row_[cell.y]) * buckets_x_ +
+           bucket_column_[cell.x];
+  }
+  int Distance(SDL_Point a, SDL_Point b) const;
+  // Few enough items that a plain scan beats the bucket rings
+  bool ScansAll() const {
+    return items_.size() <= kScanItems ||
+           items_.size() * items_.size() <= buckets_.size();
+  }
+
+  // Keep the k nearest candidates seen so far in scratch_, sorted
+  void Consider(std::uint32_t index, SDL_Point from, std::size_t k) const;
+  // Fill scratch_ with the k nearest foods
+  void Search(SDL_Point from, std::size_t k) const;
+
+  int grid_width_;
+  int grid_height_;
+
+  std::vector<Food> items_;
+  // Per item, its slot in its bucket
+  std::vector<std::uint32_t> bucket_slots_;
+  // Per cell, the index of the item on it or kNone
+  std::vector<std::uint32_t> item_at_;
+
+  // Buckets split the board as evenly as possible, so every bucket is at
+  // least min_extent_ cells across
+  int buckets_x_;
+  int buckets_y_;
+  int min_extent_;
+  std::vector<int> bucket_column_;
+  std::vector<int> bucket_row_;
+  // Per bucket, the indices of the items in it
+  std::vector<std::vector<std::uint32_t>> buckets_;
+
+  // (distance, cell index) of the best candidates of the current query
+  mutable std::vector<std::pair<int, std::uint32_t>> scratch_;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "free_cells.h"
+#include <algorithm>
+
+FreeCells::FreeCells(int grid_width, int grid_height)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      slots_(static_cast<std::size_t>(grid_width) * grid_height, kAbsent) {
+  cells_.reserve(slots_.size());
+}
+
+void FreeCells::Sync(const OccupancyGrid& world) {
+  if (!synced_) {
+    Rebuild(world);
+    return;
+  }
+  if (world.Version() == seen_version_) return;
+
+  // A cell may appear in the journal many times; only where it ended up
+  // matters
+  bool journaled = world.ForEachChangeSince(
+      seen_version_, [&](int x, int y) { Set(x, y, world.IsEmpty(x, y)); });
+  if (!journaled) {
+    Rebuild(world);
+    return;
+  }
+  seen_version_ = world.Version();
+}
+
+void FreeCells::Set(int x, int y, bool free) {
+  std::size_t index = Index(x, y);
+  std::uint32_t slot = slots_[index];
+  if (free == (slot != kAbsent)) return;
+
+  if (free) {
+    slots_[index] = static_cast<std::uint32_t>(cells_.size());
+    cells_.push_back(static_cast<std::uint32_t>(index));
+    return;
+  }
+  // Move the last entry into the gap
+  std::uint32_t last = cells_.back();
+  cells_[slot] = last;
+  slots_[last] = slot;
+  cells_.pop_back();
+  slots_[index] = kAbsent;
+}
+
+void FreeCells::Rebuild(const OccupancyGrid& world) {
+  cells_.clear();
+  std::fill(slots_.begin(), slots_.end(), kAbsent);
+  for (int y = 0; y < grid_height_; ++y) {
+    for (int x = 0; x < grid_width_; ++x) {
+      if (world.IsEmpty(x, y)) Set(x, y, true);
+    }
+  }
+  synced_ = true;
+  seen_version_ = world.Version();
+}
@@ -0,0 +1,54 @@
+#ifndef FREE_CELLS_H
+#define FREE_CELLS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "SDL.h"
+#include "occupancy_grid.h"
+
+// The cells with nothing in them, as a dense list plus each cell's slot in
+// that list, so a uniformly random free cell is a single draw however full
+// the board is. A cell joins or leaves by swapping with the last entry.
+// Follows the world through the grid's change journal, like GridBits, so
+// staying current costs in proportion to what changed.
+class FreeCells {
+ public:
+  FreeCells(int grid_width, int grid_height);
+
+  // Bring the set up to date with the world
+  void Sync(const OccupancyGrid& world);
+
+  std::size_t Size() const { return cells_.size(); }
+  bool Empty() const { return cells_.empty(); }
+  bool Contains(int x, int y) const { return slots_[Index(x, y)] != kAbsent; }
+
+  // A uniformly random free cell; the set must not be empty
+  SDL_Point Sample(std::mt19937& engine) const {
+    std::uniform_int_distribution<std::size_t> pick(0, cells_.size() - 1);
+    std::uint32_t cell = cells_[pick(engine)];
+    return SDL_Point{static_cast<int>(cell % grid_width_),
+                     static_cast<int>(cell / grid_width_)};
+  }
+
+ private:
+  static constexpr std::uint32_t kAbsent = ~std::uint32_t{0};
+
+  std::size_t Index(int x, int y) const {
+    return static_cast<std::size_t>(y) * grid_width_ + x;
+  }
+  void Set(int x, int y, bool free);
+  void Rebuild(const OccupancyGrid& world);
+
+  int grid_width_;
+  int grid_height_;
+  // Free cell indices in no particular order
+  std::vector<std::uint32_t> cells_;
+  // Per cell, its position in cells_ or kAbsent
+  std::vector<std::uint32_t> slots_;
+  bool synced_{false};
+  std::uint64_t seen_version_{0};
+};
+
+#endif
@@ -1,154 +1,211 @@
 #include "game.h"
 #include <iostream>
-#include <cmath>
+#include <algorithm>
 #include "SDL.h"
+#include "profiler.h"
 
 Game::Game(std::size_t grid_width, std::size_t grid_height, bool enable_ai)
-    : snake_(grid_width, grid_height),
-      ai_snake_(grid_width, grid_height),
-      engine_(dev_()),
-      random_w_(0, static_cast<int>(grid_width - 1)),
-      random_h_(0, static_cast<int>(grid_height - 1)),
-      ai_enabled_(enable_ai),
-      food_factory_(grid_width, grid_height) {
-  // Create obstacle manager with 5 fixed and 3 moving obstacles
+    : Game(grid_width, grid_height, Options{enable_ai}) {}
+
+Game::Game(std::size_t grid_width, std::size_t grid_height,
+           const Options &options)
+    : grid_(static_cast<int>(grid_width), static_cast<int>(grid_height)),
+      snake_(grid_width, grid_height),
+      foods_(static_cast<int>(grid_width), static_cast<int>(grid_height),
+             options.max_food_items),
+      free_cells_(static_cast<int>(grid_width),
+                  static_cast<int>(grid_height)),
+      engine_(options.seed != 0 ? options.seed : dev_()),
+      ai_enabled_(options.enable_ai),
+      threaded_ai_(options.threaded_ai),
+      food_factory_(options.food_types),
+      max_food_items_(options.max_food_items),
+      forecast_(static_cast<int>(grid_width), static_cast<int>(grid_height)) {
+  // Reserved up front so no snake moves once it is on the grid
+  std::size_t num_ai = ai_enabled_ ? std::max<std::size_t>(
+                                         options.num_ai_snakes, 1)
+                                   : 1;
+  ai_snakes_.reserve(num_ai);
+  ai_snakes_.emplace_back(static_cast<int>(grid_width),
+                          static_cast<int>(grid_height));
+  ai_scores_.assign(num_ai, 0);
+
+  snake_.AttachGrid(&grid_, OccupancyGrid::Layer::kPlayer);
+  if (ai_enabled_) {
+    ai_snakes_.front().AttachGrid(&grid_, OccupancyGrid::Layer::kAI);
+  }
+
+  // Create obstacle manager (5 fixed and 3 moving obstacles by default)
   obstacles_ = std::make_unique<ObstacleManager>(
-      grid_width, grid_height, 5, 3);
+      grid_width, grid_height, options.num_fixed_obstacles,
+      options.num_moving_obstacles, grid_, engine_());
+
+  // Further AI snakes go wherever the obstacles left room near their spot
+  // on the ring
+  for (std::size_t i = 1; i < num_ai; ++i) {
+    SDL_Point spawn = AISpawnPoint(i, num_ai);
+    int cells = grid_.Width() * grid_.Height();
+    int start = spawn.y * grid_.Width() + spawn.x;
+    for (int n = 0; n < cells; ++n) {
+      int cell = (start + n) % cells;
+      if (grid_.IsEmpty(cell % grid_.Width(), cell / grid_.Width())) {
+        spawn = SDL_Point{cell % grid_.Width(), cell / grid_.Width()};
+        break;
+      }
+    }
+    AISnake &ai = ai_snakes_.emplace_back(static_cast<int>(grid_width),
+                                          static_cast<int>(grid_height));
+    ai.PlaceHead(spawn.x, spawn.y);
+    ai.AttachGrid(&grid_, OccupancyGrid::Layer::kAI);
+  }
 
   // Place initial food items
   for (std::size_t i = 0; i < 3; ++i) {
     PlaceFood();
   }
 
-  // Start AI snake pathfinding thread only if enabled
+  // Start planning on the worker pool only if enabled
   if (ai_enabled_) {
-    ai_snake_.StartAI();
-    UpdateAIFoodTarget();
+    if (threaded_ai_) {
+      unsigned threads = options.planning_threads != 0
+                             ? options.planning_threads
+                             : PlanningService::DefaultThreads();
+      threads = static_cast<unsigned>(
+          std::min<std::size_t>(threads, ai_snakes_.size()));
+      planning_service_ = std::make_unique<PlanningService>(threads);
+    }
+    for (AISnake &ai : ai_snakes_) {
+      ai.SetPlanner(options.planner);
+      ai.SetPlanBudget(options.plan_budget);
+      if (planning_service_) ai.StartAI(*planning_service_);
+    }
   } else {
-    ai_snake_.alive = false;  // Disable AI snake
+    ai_snakes_.front().alive = false;  // Disable AI snake
   }
 }
 
 Game::~Game() {
-  // Stop AI thread before destruction
-  ai_snake_.StopAI();
+  // Leave the worker pool before destruction
+  for (AISnake &ai : ai_snakes_) ai.StopAI();
+}
+
+void Game::Step(const StepInput &inputs) {
+  if (inputs.player_direction) {
+    snake_.ChangeDirection(*inputs.player_direction);
+  }
+  Update();
 }
 
-void Game::Run(Controller const &controller, Renderer &renderer,
-               std::size_t target_frame_duration) {
-  Uint32 title_timestamp = SDL_GetTicks();
-  Uint32 frame_start;
-  Uint32 frame_end;
-  Uint32 frame_duration;
-  int fps_frame_count = 0;
-  bool running = true;
-
-  while (running) {
-    frame_start = SDL_GetTicks();
-
-    // Input, Update, Render - the main game loop.
-    controller.HandleInput(running, snake_);
-    Update();
-    renderer.Render(snake_, ai_snake_, foods_, *obstacles_, ai_enabled_);
-
-    frame_end = SDL_GetTicks();
-
-    // Keep track of how long each loop through the input/update/render cycle
-    // takes.
-    fps_frame_count++;
-    frame_duration = frame_end - frame_start;
-
-    // After every second, update the window title.
-    if (frame_end - title_timestamp >= 1000) {
-      renderer.UpdateWindowTitle(score_, ai_score_, fps_frame_count);
-      fps_frame_count = 0;
-      title_timestamp = frame_end;
+long Game::FastForward(long max_ticks) {
+  // Steps do nothing once the game is over
+  if (IsOver()) return max_ticks;
+  if (!settled_ || (ai_enabled_ && threaded_ai_)) return 0;
+
+  // The next tick at which anything but sub-cell movement happens is run
+  // by Step(); everything before it can be skipped
+  long quiet = max_ticks;
+  auto until = [&](long ticks_to_event) {
+    quiet = std::min(quiet, ticks_to_event - 1);
+  };
+  if (foods_.Size() < max_food_items_) {
+    until(kFoodSpawnInterval - frame_count_ % kFoodSpawnInterval);
+  }
+  until(kObstacleUpdateInterval - frame_count_ % kObstacleUpdateInterval);
+  if (snake_.alive) until(snake_.TicksToNextCell());
+  if (ai_enabled_) {
+    for (const AISnake &ai : ai_snakes_) {
+      if (ai.alive) until(ai.TicksToNextCell());
     }
+  }
+  if (quiet <= 0) return 0;
 
-    // If the time for this frame is too small (i.e. frame_duration is
-    // smaller than the target ms_per_frame), delay the loop to
-    // achieve the correct frame rate.
-    if (frame_duration < target_frame_duration) {
-      SDL_Delay(target_frame_duration - frame_duration);
+  int ticks = static_cast<int>(quiet);
+  frame_count_ += ticks;
+  if (snake_.alive) snake_.Coast(ticks);
+  if (ai_enabled_) {
+    for (AISnake &ai : ai_snakes_) {
+      if (ai.alive) ai.Coast(ticks);
     }
   }
+  return quiet;
 }
 
-void Game::PlaceFood() {
-  if (foods_.size() >= kMaxFoodItems) return;
-
-  int x, y;
-  int attempts = 0;
-  const int max_attempts = 100;
-  std::unique_ptr<Food> new_food;
-
-  do {
-    new_food = food_factory_.CreateRandomFood(engine_);
-    x = new_food->GetX();
-    y = new_food->GetY();
-    attempts++;
-  } while (!IsValidFoodPosition(x, y) && attempts < max_attempts);
-
-  if (attempts < max_attempts) {
-    foods_.push_back(std::move(new_food));
+bool Game::IsOver() const {
+  if (snake_.alive) return false;
+  if (!ai_enabled_) return true;
+  for (const AISnake &ai : ai_snakes_) {
+    if (ai.alive) return false;
   }
+  return true;
 }
 
-bool Game::IsValidFoodPosition(int x, int y) const {
-  // Check against player snake
-  if (snake_.SnakeCell(x, y)) {
-    return false;
-  }
+int Game::GetAIScore() const {
+  return *std::max_element(ai_scores_.begin(), ai_scores_.end());
+}
 
-  // Check against AI snake
-  if (ai_snake_.SnakeCell(x, y)) {
-    return false;
+SDL_Point Game::AISpawnPoint(std::size_t index, std::size_t count) const {
+  // Evenly spaced round the square between the board's quarter lines,
+  // clockwise on screen from its bottom-right corner. Positions are in
+  // quarters of the board, scaled by `count` so that integers stay exact
+  // and spawn points come out the same on every platform.
+  long n = static_cast<long>(count);
+  long along = 4 * static_cast<long>(index);
+  long side = along / n;
+  long part = 2 * (along % n);  // of 2n, the length of a side
+  long qx = 0, qy = 0;
+  switch (side) {
+    case 0: qx = 3 * n - part; qy = 3 * n; break;  // bottom, leftwards
+    case 1: qx = n; qy = 3 * n - part; break;      // left, upwards
+    case 2: qx = n + part; qy = n; break;          // top, rightwards
+    default: qx = 3 * n; qy = n + part; break;     // right, downwards
   }
+  int x = static_cast<int>(grid_.Width() * qx / (4 * n));
+  int y = static_cast<int>(grid_.Height() * qy / (4 * n));
+  return SDL_Point{std::clamp(x, 0, grid_.Width() - 1),
+                   std::clamp(y, 0, grid_.Height() - 1)};
+}
 
-  // Check against obstacles
-  if (obstacles_->IsObstacleAt(x, y)) {
-    return false;
+bool Game::OtherAISnakeCell(int x, int y, const AISnake *self) const {
+  if (!ai_enabled_) return false;
+  for (const AISnake &ai : ai_snakes_) {
+    if (&ai != self && ai.alive && ai.SnakeCell(x, y)) return true;
   }
+  return false;
+}
 
-  // Check against existing food
-  for (const auto& food : foods_) {
-    if (food->IsAt(x, y)) {
-      return false;
-    }
-  }
+bool Game::PlaceFood() {
+  if (foods_.Size() >= max_food_items_) return false;
+
+  // One draw from the free cells, however crowded the board
+  free_cells_.Sync(grid_);
+  if (free_cells_.Empty()) return false;
+  SDL_Point cell = free_cells_.Sample(engine_);
 
+  grid_.Add(cell.x, cell.y, OccupancyGrid::Layer::kFood);
+  foods_.Add(food_factory_.CreateRandomFood(cell.x, cell.y, engine_));
   return true;
 }
 
-void Game::UpdateAIFoodTarget() {
-  if (foods_.empty()) return;
-
-  // Find closest food to AI snake
-  int ai_x = static_cast<int>(ai_snake_.head_x);
-  int ai_y = static_cast<int>(ai_snake_.head_y);
-
-  int closest_dist = WINT_MAX;
-  int target_x = 0, target_y = 0;
+bool Game::IsBoardFull() const {
+  free_cells_.Sync(grid_);
+  return free_cells_.Empty();
+}
 
-  for (const auto& food : foods_) {
-    int dx = std::abs(food->GetX() - ai_x);
-    int dy = std::abs(food->GetY() - ai_y);
-    int dist = dx + dy;
-    if (dist < closest_dist) {
-      closest_dist = dist;
-      target_x = food->GetX();
-      target_y = food->GetY();
-    }
-  }
+bool Game::EatFoodAt(int x, int y, Snake &snake, int &score) {
+  // Food is indexed by cell, so there is nothing to search
+  if (foods_.At(x, y) == nullptr) return false;
 
-  ai_snake_.SetFoodTarget(target_x, target_y);
+  Food food = foods_.Take(x, y);
+  food_factory_.Types().Traits(food.GetType()).Apply(snake, score);
+  grid_.Remove(x, y, OccupancyGrid::Layer::kFood);
+  return true;
 }
 
 void Game::Update() {
+  PROFILE_ZONE("Game::Update");
+  if (IsOver()) return;
   bool player_active = snake_.alive;
-  bool ai_active = ai_enabled_ && ai_snake_.alive;
-
-  if (!player_active && !ai_active) return;
+  std::uint64_t version = grid_.Version();
 
   frame_count_++;
 
@@ -166,87 +223,154 @@ void Game::Update() {
   if (player_active) {
     snake_.Update();
 
-    int new_x = static_cast<int>(snake_.head_x);
-    int new_y = static_cast<int>(snake_.head_y);
+    int new_x = snake_.HeadX();
+    int new_y = snake_.HeadY();
 
     // Check collision with obstacles
     if (obstacles_->CheckCollision(snake_.body, new_x, new_y)) {
       snake_.alive = false;
     }
 
-    // Check collision with AI snake (only if AI enabled)
-    if (ai_active && ai_snake_.SnakeCell(new_x, new_y)) {
+    // Check collision with AI snakes (only if AI enabled)
+    if (OtherAISnakeCell(new_x, new_y, nullptr)) {
       snake_.alive = false;
     }
 
     // Check if player snake got any food
     if (snake_.alive) {
-      for (auto it = foods_.begin(); it != foods_.end(); ) {
-        if ((*it)->IsAt(new_x, new_y)) {
-          (*it)->ApplyEffect(snake_, score_);
-          it = foods_.erase(it);
-          if (ai_enabled_) UpdateAIFoodTarget();
-        } else {
-          ++it;
-        }
-      }
+      EatFoodAt(new_x, new_y, snake_, score_);
     }
   }
 
-  // Update AI snake only if enabled
+  // Update AI snakes only if enabled
   if (ai_enabled_) {
-    UpdateAISnake();
+    for (std::size_t i = 0; i < ai_snakes_.size(); ++i) UpdateAISnake(i);
   }
-}
 
-void Game::UpdateAISnake() {
-  if (!ai_snake_.alive) return;
+  // Nothing to replan or react to next tick unless the grid changed
+  settled_ = grid_.Version() == version;
+}
 
-  // Collect obstacle positions for pathfinding
-  std::vector<SDL_Point> obstacle_positions;
-  for (const auto& obstacle : obstacles_->GetObstacles()) {
-    for (const auto& cell : obstacle->GetOccupiedCells()) {
-      obstacle_positions.push_back(cell);
+void Game::UpdateAISnake(std::size_t index) {
+  PROFILE_ZONE("UpdateAISnake");
+  AISnake &ai = ai_snakes_[index];
+  if (!ai.alive) return;
+
+  // Replan whenever food or the walkable area changed: hand the planning
+  // service a snapshot, or plan inline. The planner heads for whichever food
+  // is nearest by true path length, counting on cells that will clear.
+  if (ai.NeedsReplan(grid_)) {
+    if (threaded_ai_) {
+      ForecastMotion(ai, ai.NextForecast());
+      ai.PublishWorld(grid_);
+    } else {
+      ForecastMotion(ai, forecast_);
+      ai.PlanPath(grid_, forecast_);
     }
   }
-  ai_snake_.SetObstacles(obstacle_positions);
-
-  // Update AI with player snake position
-  ai_snake_.SetPlayerSnakeBody(snake_.body,
-                               static_cast<int>(snake_.head_x),
-                               static_cast<int>(snake_.head_y));
 
   // Update AI direction based on path
-  ai_snake_.UpdateAI();
+  ai.UpdateAI(grid_);
 
   // Update AI snake movement
-  ai_snake_.Update();
+  ai.Update();
 
-  int ai_x = static_cast<int>(ai_snake_.head_x);
-  int ai_y = static_cast<int>(ai_snake_.head_y);
+  int ai_x = ai.HeadX();
+  int ai_y = ai.HeadY();
 
   // Check AI collision with obstacles
-  if (obstacles_->CheckCollision(ai_snake_.body, ai_x, ai_y)) {
-    ai_snake_.alive = false;
+  if (obstacles_->CheckCollision(ai.body, ai_x, ai_y)) {
+    ai.alive = false;
   }
 
-  // Check AI collision with player snake
-  if (snake_.alive && snake_.SnakeCell(ai_x, ai_y)) {
-    ai_snake_.alive = false;
+  // Check AI collision with the player and the other AI snakes
+  if ((snake_.alive && snake_.SnakeCell(ai_x, ai_y)) ||
+      OtherAISnakeCell(ai_x, ai_y, &ai)) {
+    ai.alive = false;
   }
 
   // Check if AI snake got any food
-  if (ai_snake_.alive) {
-    for (auto it = foods_.begin(); it != foods_.end(); ) {
-      if ((*it)->IsAt(ai_x, ai_y)) {
-        (*it)->ApplyEffect(ai_snake_, ai_score_);
-        it = foods_.erase(it);
-        UpdateAIFoodTarget();
-      } else {
-        ++it;
+  if (ai.alive) {
+    EatFoodAt(ai_x, ai_y, ai, ai_scores_[index]);
+  }
+}
+
+namespace {
+
+// Whole ticks a snake takes to cross one cell at its current speed,
+// rounded to the nearest
+int TicksPerCell(const Snake &snake) {
+  return std::max(1, (kSubcellsPerCell + snake.speed / 2) / snake.speed);
+}
+
+}  // namespace
+
+void Game::ForecastMotion(const AISnake &self,
+                          MotionForecast &forecast) const {
+  PROFILE_ZONE("ForecastMotion");
+  std::fill(forecast.free_at.begin(), forecast.free_at.end(), 0);
+
+  // The AI body drains from the tail one cell per step; each segment of
+  // pending growth holds everything in place for one more step
+  int ai_tpc = TicksPerCell(self);
+  int ai_growing = self.PendingGrowth();
+  const SnakeBody &ai_body = self.body;
+  forecast.ticks_per_step = ai_tpc;
+  forecast.ai_length = static_cast<int>(ai_body.size()) + ai_growing;
+  for (std::size_t i = 0; i < ai_body.size(); ++i) {
+    forecast.BlockUntil(ai_body[i].x, ai_body[i].y,
+                        static_cast<std::uint16_t>(std::min<std::size_t>(
+                            i + 1 + ai_growing, MotionForecast::kNever)));
+  }
+
+  // Other snakes drain at their own speed, converted to AI steps and
+  // rounded so that the AI never arrives early. Where their heads go next
+  // is anyone's guess, so the head cells stay blocked.
+  auto forecast_other = [&](const Snake &other) {
+    int other_tpc = TicksPerCell(other);
+    int other_growing = other.PendingGrowth();
+    const SnakeBody &body = other.body;
+    for (std::size_t i = 0; i < body.size(); ++i) {
+      long release = static_cast<long>(i + 1 + other_growing) * other_tpc + 1;
+      long step = (release + ai_tpc - 1) / ai_tpc + 1;
+      forecast.BlockUntil(body[i].x, body[i].y,
+                          static_cast<std::uint16_t>(std::min<long>(
+                              step, MotionForecast::kNever)));
+    }
+    forecast.BlockUntil(other.HeadX(), other.HeadY(), MotionForecast::kNever);
+  };
+  if (snake_.alive) forecast_other(snake_);
+
+  // A dead AI snake's body stays where it fell
+  for (const AISnake &other : ai_snakes_) {
+    if (&other == &self) continue;
+    if (other.alive) {
+      forecast_other(other);
+    } else {
+      for (const SDL_Point &cell : other.body) {
+        forecast.BlockUntil(cell.x, cell.y, MotionForecast::kNever);
       }
+      forecast.BlockUntil(other.HeadX(), other.HeadY(),
+                          MotionForecast::kNever);
     }
   }
+
+  // Obstacles move on a fixed schedule, far enough ahead to cover the
+  // longest path the space-time search may consider
+  int ticks_to_update =
+      kObstacleUpdateInterval - frame_count_ % kObstacleUpdateInterval;
+  int horizon_ticks = (SpaceTimePlanner::kHorizon + 1) * ai_tpc + 1;
+  int updates = horizon_ticks < ticks_to_update
+                    ? 0
+                    : 1 + (horizon_ticks - ticks_to_update) /
+                              kObstacleUpdateInterval;
+  obstacles_->Forecast(updates, ticks_to_update, kObstacleUpdateInterval,
+                       forecast);
+
+  // Only the nearest few foods are worth heading for, however many there
+  // are on the board
+  foods_.Nearest(self.HeadCell(), MotionForecast::kMaxGoals,
+                 forecast.goals);
 }
 
 int Game::GetScore() const { return score_; }
@@ -1,57 +1,150 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <random>
 #include <memory>
 #include <string>
 #include <vector>
 #include "SDL.h"
-#include "controller.h"
-#include "renderer.h"
 #include "snake.h"
 #include "food.h"
+#include "food_pool.h"
+#include "free_cells.h"
 #include "obstacle.h"
+#include "occupancy_grid.h"
+#include "motion_forecast.h"
 #include "ai_snake.h"
+#include "planning_service.h"
+
+class Controller;
+class Renderer;
 
 class Game {
  public:
+  // Player input applied at the start of one simulation tick
+  struct StepInput {
+    std::optional<Snake::Direction> player_direction;
+  };
+
+  // Construction options for headless and batch runs
+  struct Options {
+    bool enable_ai{true};
+    // AI opponents, spread around the board
+    std::size_t num_ai_snakes{1};
+    // Plan AI paths on a pool of worker threads shared by all AI snakes;
+    // otherwise plan inline in Update
+    bool threaded_ai{true};
+    // Workers in that pool; 0 = one per hardware thread less one, but
+    // never more than there are AI snakes
+    unsigned planning_threads{0};
+    // Seed for all game randomness; 0 picks a random seed
+    std::uint32_t seed{0};
+    std::size_t num_fixed_obstacles{5};
+    std::size_t num_moving_obstacles{3};
+    std::size_t max_food_items{5};
+    // Food types spawned, and how often each one spawns
+    FoodRegistry food_types;
+    // Static planner behind the AI snakes' paths
+    AISnake::Planner planner{AISnake::Planner::kDStarLite};
+    // Time a planning worker may spend per plan (0 = no limit)
+    std::chrono::microseconds plan_budget{AISnake::kDefaultPlanBudget};
+  };
+
   Game(std::size_t grid_width, std::size_t grid_height, bool enable_ai = true);
+  Game(std::size_t grid_width, std::size_t grid_height, const Options &options);
   ~Game();
 
+  // Fixed simulation rate; Run() steps at this rate whatever the frame rate
+  static constexpr int kTicksPerSecond = 60;
+
+  // Interactive SDL loop (defined in game_loop.cpp, not part of snake_core).
+  // target_frame_duration is the minimum time per rendered frame in ms.
   void Run(Controller const &controller, Renderer &renderer,
            std::size_t target_frame_duration);
+
+  // Advance the simulation by one tick without any window or timing.
+  void Step(const StepInput &inputs);
+
+  // Skip ahead over up to max_ticks ticks in which Step() would only move
+  // the snakes within their cells: no snake enters another cell and no food
+  // or obstacle update is due. The snakes end up exactly where stepping
+  // would have put them. This holds only if the last Step() changed
+  // nothing in the grid, and if the inputs for the skipped ticks would
+  // have been those of the last Step(), as they are for input derived from
+  // the cells of the world. Returns the number of ticks skipped; all of
+  // max_ticks once the game is over, and 0 while AI snakes plan on worker
+  // threads, whose plans may land any time. Skipped ticks are the cheap
+  // ones, so this pays off only where a tick costs little, as without AI.
+  long FastForward(long max_ticks);
+
+  // True once no snake is alive; further steps do nothing
+  bool IsOver() const;
+
+  // Spawn one random food item on a uniformly random free cell; false if
+  // none was placed, because the food cap is reached or the board is full
+  bool PlaceFood();
+
+  // Is every cell taken by a snake, an obstacle or food?
+  bool IsBoardFull() const;
+
   int GetScore() const;
   int GetSize() const;
+  // Best score among the AI snakes
+  int GetAIScore() const;
+  const std::vector<int>& GetAIScores() const { return ai_scores_; }
+  int GetFrameCount() const { return frame_count_; }
+  const Snake& GetSnake() const { return snake_; }
+  const OccupancyGrid& GetGrid() const { return grid_; }
 
   // Set player name for high score
   void SetPlayerName(const std::string& name) { player_name_ = name; }
   std::string GetPlayerName() const { return player_name_; }
 
-  // Get AI snake for rendering
-  const AISnake& GetAISnake() const { return ai_snake_; }
+  // Get AI snakes for rendering; the first is always there, though dead
+  // when AI is disabled
+  const AISnake& GetAISnake() const { return ai_snakes_.front(); }
+  const std::vector<AISnake>& GetAISnakes() const { return ai_snakes_; }
   bool IsAIEnabled() const { return ai_enabled_; }
 
+  // Null unless AI snakes plan on worker threads
+  PlanningService* GetPlanningService() const {
+    return planning_service_.get();
+  }
+
   // Get obstacles for rendering
   const ObstacleManager& GetObstacles() const { return *obstacles_; }
 
-  // Get all food items for rendering
-  const std::vector<std::unique_ptr<Food>>& GetFoods() const { return foods_; }
+  // Get all food items for rendering, in no particular order
+  const std::vector<Food>& GetFoods() const { return foods_.Items(); }
+  // The same food indexed by cell and by neighbourhood
+  const FoodPool& GetFoodPool() const { return foods_; }
+  // What each type of food does and looks like
+  const FoodRegistry& GetFoodTypes() const { return food_factory_.Types(); }
 
  private:
+  // Shared world occupancy, kept in sync by every entity that moves
+  OccupancyGrid grid_;
   Snake snake_;
-  AISnake ai_snake_;
-  std::vector<std::unique_ptr<Food>> foods_;
+  // Declared before the snakes so that it outlives them
+  std::unique_ptr<PlanningService> planning_service_;
+  std::vector<AISnake> ai_snakes_;
+  // Reserved up front for max_food_items
+  FoodPool foods_;
+  // Empty cells for food placement, synced with grid_ only when asked
+  mutable FreeCells free_cells_;
   std::unique_ptr<ObstacleManager> obstacles_;
 
   std::random_device dev_;
   std::mt19937 engine_;
-  std::uniform_int_distribution<int> random_w_;
-  std::uniform_int_distribution<int> random_h_;
 
   int score_{0};
-  int ai_score_{0};
+  std::vector<int> ai_scores_;
   std::string player_name_;
   bool ai_enabled_{true};
+  bool threaded_ai_{true};
 
   // Food factory for creating different food types
   FoodFactory food_factory_;
@@ -60,13 +153,29 @@ class Game {
   int frame_count_{0};
   static constexpr int kFoodSpawnInterval = 5;
   static constexpr int kObstacleUpdateInterval = 15;
-  static constexpr std::size_t kMaxFoodItems = 5;
+  std::size_t max_food_items_;
+
+  // Did the last Update leave the grid as it found it?
+  bool settled_{false};
 
-  void PlaceFood();
+  // Reused for every AI replan made inline (threaded snakes forecast into
+  // their own snapshot)
+  MotionForecast forecast_;
+
+  bool EatFoodAt(int x, int y, Snake &snake, int &score);
   void Update();
-  void UpdateAISnake();
-  bool IsValidFoodPosition(int x, int y) const;
-  void UpdateAIFoodTarget();
+  void UpdateAISnake(std::size_t index);
+
+  // Is the cell part of an AI snake other than `self`?
+  bool OtherAISnakeCell(int x, int y, const AISnake *self) const;
+
+  // Where AI snake `index` of `count` starts: the first bottom-right, the
+  // rest spaced around a square ring about the centre
+  SDL_Point AISpawnPoint(std::size_t index, std::size_t count) const;
+
+  // Predict when occupied cells clear and where moving obstacles will be,
+  // from the point of view of one AI snake
+  void ForecastMotion(const AISnake &self, MotionForecast &forecast) const;
 };
 
 #endif
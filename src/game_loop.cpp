@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include "game.h"
+#include "SDL.h"
+#include "controller.h"
+#include "profiler.h"
+#include "renderer.h"
+
+// The interactive loop lives outside snake_core so the simulation itself
+// has no dependency on an SDL window, timer or event queue.
+//
+// The simulation advances in fixed ticks of 1/kTicksPerSecond regardless of
+// how fast frames are rendered: elapsed wall time is banked in an
+// accumulator and spent one tick at a time, and the remainder becomes the
+// interpolation factor handed to the renderer.
+void Game::Run(Controller const &controller, Renderer &renderer,
+               std::size_t target_frame_duration) {
+  using Clock = std::chrono::steady_clock;
+  constexpr Clock::duration kTick = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / kTicksPerSecond));
+  // Cap the time banked per frame so a long stall (window drag, debugger)
+  // does not trigger a burst of catch-up ticks
+  constexpr Clock::duration kMaxFrameTime = std::chrono::milliseconds(250);
+
+  Uint32 title_timestamp = SDL_GetTicks();
+  Uint32 frame_start;
+  Uint32 frame_end;
+  Uint32 frame_duration;
+  int fps_frame_count = 0;
+  bool running = true;
+
+  Clock::time_point previous = Clock::now();
+  Clock::duration accumulator = Clock::duration::zero();
+
+  Profiler &profiler = Profiler::Instance();
+
+  while (running) {
+    frame_start = SDL_GetTicks();
+    std::uint64_t work_start_ns = Profiler::NowNs();
+
+    Clock::time_point now = Clock::now();
+    accumulator += std::min<Clock::duration>(now - previous, kMaxFrameTime);
+    previous = now;
+
+    // Input, Update, Render - the main game loop.
+    {
+      PROFILE_ZONE("Frame");
+      {
+        PROFILE_ZONE("Input");
+        controller.HandleInput(running, snake_);
+      }
+      while (accumulator >= kTick) {
+        Update();
+        accumulator -= kTick;
+      }
+      float alpha = static_cast<float>(accumulator.count()) /
+                    static_cast<float>(kTick.count());
+      {
+        PROFILE_ZONE("Renderer::Render");
+        renderer.Render(snake_, ai_snakes_, foods_.Items(),
+                        food_factory_.Types(), *obstacles_, ai_enabled_,
+                        alpha);
+      }
+    }
+
+    frame_end = SDL_GetTicks();
+    if (profiler.Enabled()) {
+      profiler.RecordFrame(Profiler::NowNs() - work_start_ns);
+    }
+
+    // Keep track of how long each loop through the input/update/render cycle
+    // takes.
+    fps_frame_count++;
+    frame_duration = frame_end - frame_start;
+
+    // After every second, update the window title.
+    if (frame_end - title_timestamp >= 1000) {
+      renderer.UpdateWindowTitle(score_, GetAIScore(), fps_frame_count);
+      fps_frame_count = 0;
+      title_timestamp = frame_end;
+    }
+
+    // Rendering is paced by vsync; the delay only caps the frame rate when
+    // vsync is unavailable so the loop does not spin a core.
+    if (frame_duration < target_frame_duration) {
+      SDL_Delay(target_frame_duration - frame_duration);
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#include "grid_bits.h"
+#include <algorithm>
+
+GridBits::GridBits(int grid_width, int grid_height)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      words_per_row_((grid_width + 63) / 64),
+      last_word_mask_(grid_width % 64 == 0
+                          ? ~std::uint64_t{0}
+                          : (std::uint64_t{1} << (grid_width % 64)) - 1),
+      words_(static_cast<std::size_t>(words_per_row_) * grid_height, 0) {}
+
+void GridBits::Sync(const OccupancyGrid& world) {
+  if (!synced_) {
+    Rebuild(world);
+    return;
+  }
+  if (world.Version() == seen_version_) return;
+
+  bool journaled = world.ForEachChangeSince(
+      seen_version_, [&](int x, int y) { Set(x, y, world.IsBlocked(x, y)); });
+  if (!journaled) {
+    Rebuild(world);
+    return;
+  }
+  seen_version_ = world.Version();
+}
+
+void GridBits::Rebuild(const OccupancyGrid& world) {
+  std::fill(words_.begin(), words_.end(), 0);
+  for (int y = 0; y < grid_height_; ++y) {
+    for (int x = 0; x < grid_width_; ++x) {
+      if (world.IsBlocked(x, y)) Set(x, y, true);
+    }
+  }
+  synced_ = true;
+  seen_version_ = world.Version();
+}
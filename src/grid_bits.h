@@ -0,0 +1,58 @@
+#ifndef GRID_BITS_H
+#define GRID_BITS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "occupancy_grid.h"
+
+// One bit per cell marking where a snake or an obstacle blocks movement,
+// packed into whole 64-bit words per row so searches can test or scan 64
+// cells at once. Follows one evolving world (or copies of it) through the
+// grid's change journal, so staying current costs in proportion to what
+// changed.
+class GridBits {
+ public:
+  GridBits(int grid_width, int grid_height);
+
+  // Bring the bits up to date with the world
+  void Sync(const OccupancyGrid& world);
+
+  bool Test(int x, int y) const {
+    return (words_[Word(x, y)] >> (x & 63)) & 1;
+  }
+  void Set(int x, int y, bool on) {
+    std::uint64_t bit = std::uint64_t{1} << (x & 63);
+    if (on) {
+      words_[Word(x, y)] |= bit;
+    } else {
+      words_[Word(x, y)] &= ~bit;
+    }
+  }
+
+  const std::uint64_t *Row(int y) const {
+    return &words_[static_cast<std::size_t>(y) * words_per_row_];
+  }
+
+  int WordsPerRow() const { return words_per_row_; }
+  // Bits of word w that hold cells (the last word of a row may be partial)
+  std::uint64_t ValidMask(int w) const {
+    return w == words_per_row_ - 1 ? last_word_mask_ : ~std::uint64_t{0};
+  }
+
+ private:
+  std::size_t Word(int x, int y) const {
+    return static_cast<std::size_t>(y) * words_per_row_ + (x >> 6);
+  }
+  void Rebuild(const OccupancyGrid& world);
+
+  int grid_width_;
+  int grid_height_;
+  int words_per_row_;
+  std::uint64_t last_word_mask_;
+  std::vector<std::uint64_t> words_;
+  bool synced_{false};
+  std::uint64_t seen_version_{0};
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef GRID_GEOMETRY_H
+#define GRID_GEOMETRY_H
+
+#include <algorithm>
+#include <cstdlib>
+
+// Cell arithmetic on the wrapping grid: joining and splitting cell indices
+// (y * width + x), stepping to a neighbour with wrap-around, and torus
+// distances. The searches do this for every cell they touch. Keeping it in
+// one place lets a search avoid the general division per cell; in the
+// flood-fill benchmark the three variants below measure within noise of
+// each other, so the choice mostly matters where a search does little else
+// per cell.
+//
+// GridGeometry holds the dimensions at run time and, when the width is a
+// power of two, splits cells with a shift and a mask instead of dividing.
+// Grid<W, H> has the dimensions as constants, so the compiler folds them in:
+// power-of-two sizes wrap with masks and the rest divide by multiplying.
+// Both offer the same members, so a search written once as a template on
+// its geometry gets a fully specialized copy per board size through
+// WithGeometry() and still handles any other size.
+class GridGeometry {
+ public:
+  GridGeometry(int width, int height)
+      : width_(width), height_(height), shift_(-1), mask_(0) {
+    if ((width & (width - 1)) == 0) {
+      shift_ = 0;
+      while ((1 << shift_) < width) shift_++;
+      mask_ = width - 1;
+    }
+  }
+
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+
+  int Cell(int x, int y) const { return y * width_ + x; }
+  int X(int cell) const { return shift_ >= 0 ? cell & mask_ : cell % width_; }
+  int Y(int cell) const {
+    return shift_ >= 0 ? cell >> shift_ : cell / width_;
+  }
+
+  // One step along an axis, wrapping
+  int Right(int x) const { return x + 1 == width_ ? 0 : x + 1; }
+  int Left(int x) const { return x == 0 ? width_ - 1 : x - 1; }
+  int Down(int y) const { return y + 1 == height_ ? 0 : y + 1; }
+  int Up(int y) const { return y == 0 ? height_ - 1 : y - 1; }
+
+  // Manhattan distance on the torus
+  int Distance(int x0, int y0, int x1, int y1) const {
+    int dx = std::abs(x0 - x1);
+    int dy = std::abs(y0 - y1);
+    return std::min(dx, width_ - dx) + std::min(dy, height_ - dy);
+  }
+
+ private:
+  int width_;
+  int height_;
+  int shift_;  // log2 of the width, or -1 if it is not a power of two
+  int mask_;
+};
+
+template <int W, int H>
+class Grid {
+  static_assert(W > 0 && H > 0, "grid dimensions must be positive");
+
+ public:
+  static constexpr int Width() { return W; }
+  static constexpr int Height() { return H; }
+
+  // Cells are never negative; unsigned arithmetic lets the compiler use a
+  // plain mask and shift for power-of-two widths
+  static constexpr int Cell(int x, int y) { return y * W + x; }
+  static constexpr int X(int cell) {
+    return static_cast<int>(static_cast<unsigned>(cell) % W);
+  }
+  static constexpr int Y(int cell) {
+    return static_cast<int>(static_cast<unsigned>(cell) / W);
+  }
+
+  static constexpr int Right(int x) { return x + 1 == W ? 0 : x + 1; }
+  static constexpr int Left(int x) { return x == 0 ? W - 1 : x - 1; }
+  static constexpr int Down(int y) { return y + 1 == H ? 0 : y + 1; }
+  static constexpr int Up(int y) { return y == 0 ? H - 1 : y - 1; }
+
+  static int Distance(int x0, int y0, int x1, int y1) {
+    int dx = std::abs(x0 - x1);
+    int dy = std::abs(y0 - y1);
+    return std::min(dx, W - dx) + std::min(dy, H - dy);
+  }
+};
+
+// Call f with the geometry of `geometry`'s board: a Grid<N, N> for the
+// square power-of-two boards the game and benchmarks use, `geometry`
+// itself for any other size
+template <typename F>
+decltype(auto) WithGeometry(const GridGeometry& geometry, F&& f) {
+  if (geometry.Width() == geometry.Height()) {
+    switch (geometry.Width()) {
+      case 32: return f(Grid<32, 32>{});
+      case 64: return f(Grid<64, 64>{});
+      case 128: return f(Grid<128, 128>{});
+      case 256: return f(Grid<256, 256>{});
+      case 512: return f(Grid<512, 512>{});
+      case 1024: return f(Grid<1024, 1024>{});
+      case 2048: return f(Grid<2048, 2048>{});
+    }
+  }
+  return f(geometry);
+}
+
+#endif
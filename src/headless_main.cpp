@@ -0,0 +1,183 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "game.h"
+#include "profiler.h"
+
+// Runs the simulation without a window for a fixed number of ticks, as fast
+// as the CPU allows, and reports throughput.
+// Usage: snake_headless [ticks] [grid_width] [grid_height] [--no-ai]
+//                       [--trace file.json] [--planner dstar|astar|jps|hpa]
+//                       [--plan-budget-us N] [--ai-snakes N]
+//                       [--planning-threads N] [--max-food N]
+//                       [--food-types file] [--inline-planning]
+//                       [--fast-forward] [--seed N]
+int main(int argc, char *argv[]) {
+  long ticks = 100000;
+  std::size_t grid_width = 32;
+  std::size_t grid_height = 32;
+  Game::Options options;
+  std::string trace_file;
+  bool fast_forward = false;
+  bool usage_error = false;
+
+  int positional = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    // A flag that takes a value must not swallow the end of the command
+    // line, or fall through to be read as a tick count or grid size
+    bool takes_value = arg == "--trace" || arg == "--planner" ||
+                       arg == "--plan-budget-us" || arg == "--ai-snakes" ||
+                       arg == "--planning-threads" || arg == "--max-food" ||
+                       arg == "--food-types" || arg == "--seed";
+    if (takes_value && i + 1 == argc) {
+      usage_error = true;
+      break;
+    }
+    if (arg == "--no-ai") {
+      options.enable_ai = false;
+    } else if (arg == "--trace") {
+      trace_file = argv[++i];
+    } else if (arg == "--planner") {
+      if (!AISnake::ParsePlanner(argv[++i], options.planner)) {
+        usage_error = true;
+      }
+    } else if (arg == "--plan-budget-us") {
+      options.plan_budget = std::chrono::microseconds(std::atol(argv[++i]));
+    } else if (arg == "--ai-snakes") {
+      options.num_ai_snakes = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--planning-threads") {
+      options.planning_threads =
+          static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--max-food") {
+      options.max_food_items = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--food-types") {
+      std::ifstream in(argv[++i]);
+      std::string error = "cannot open";
+      if (!in || !options.food_types.Read(in, error)) {
+        std::cerr << argv[i] << ": " << error << "\n";
+        return 1;
+      }
+    } else if (arg == "--seed") {
+      options.seed =
+          static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--inline-planning") {
+      options.threaded_ai = false;
+    } else if (arg == "--fast-forward") {
+      // Skipping ticks needs plans made inline, at known ticks
+      fast_forward = true;
+      options.threaded_ai = false;
+    } else if (positional == 0) {
+      ticks = std::atol(argv[i]);
+      positional++;
+    } else if (positional == 1) {
+      grid_width = std::strtoul(argv[i], nullptr, 10);
+      grid_height = grid_width;
+      positional++;
+    } else {
+      grid_height = std::strtoul(argv[i], nullptr, 10);
+    }
+  }
+
+  // Obstacles keep a 9x9 area clear around the spawn point
+  if (usage_error || ticks <= 0 || grid_width < 16 || grid_height < 16 ||
+      grid_width > kMaxGridCells || grid_height > kMaxGridCells) {
+    std::cerr << "usage: snake_headless [ticks] [grid_width] [grid_height]"
+                 " [--no-ai] [--trace file.json]\n"
+                 "                      [--planner dstar|astar|jps|hpa]"
+                 " [--plan-budget-us N]\n"
+                 "                      [--ai-snakes N]"
+                 " [--planning-threads N] [--max-food N]\n"
+                 "                      [--food-types file]"
+                 " [--inline-planning] [--fast-forward]\n"
+                 "                      [--seed N]\n"
+                 "       grid dimensions must be from 16 to "
+              << kMaxGridCells << "\n";
+    return 1;
+  }
+
+  Profiler &profiler = Profiler::Instance();
+  if (!trace_file.empty()) {
+    profiler.SetEnabled(true);
+    profiler.SetThreadName("main");
+  }
+
+  Game game(grid_width, grid_height, options);
+
+  auto start = std::chrono::steady_clock::now();
+  Game::StepInput no_input;
+  long steps = 0;
+  // Ticks played before the game ended (or all of them); throughput is
+  // counted over these, as the steps of a finished game do nothing
+  long played = 0;
+  for (long t = 0; t < ticks && !game.IsOver(); ++t) {
+    if (profiler.Enabled()) {
+      std::uint64_t step_start_ns = Profiler::NowNs();
+      game.Step(no_input);
+      profiler.RecordFrame(Profiler::NowNs() - step_start_ns);
+    } else {
+      game.Step(no_input);
+    }
+    steps++;
+    if (fast_forward && !game.IsOver()) {
+      t += game.FastForward(ticks - t - 1);
+    }
+    played = t + 1;
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << "ticks: " << played;
+  if (played < ticks) std::cout << " of " << ticks << " (game over)";
+  std::cout << "\n";
+  std::cout << "grid: " << grid_width << "x" << grid_height << "\n";
+  std::cout << "elapsed: " << seconds << " s\n";
+  std::cout << "ticks/sec: " << (seconds > 0 ? played / seconds : 0) << "\n";
+  if (fast_forward) std::cout << "ticks stepped: " << steps << "\n";
+  std::cout << "player score: " << game.GetScore()
+            << (game.GetSnake().alive ? "" : " (dead)") << "\n";
+  if (options.enable_ai) {
+    const std::vector<AISnake> &ai_snakes = game.GetAISnakes();
+    AISnake::PlanStats plans;
+    std::cout << (ai_snakes.size() > 1 ? "ai scores:" : "ai score:");
+    for (std::size_t i = 0; i < ai_snakes.size(); ++i) {
+      std::cout << (i > 0 ? ", " : " ") << game.GetAIScores()[i]
+                << (ai_snakes[i].alive ? "" : " (dead)");
+      plans.Add(ai_snakes[i].GetPlanStats());
+    }
+    std::cout << "\n";
+    const PlanningService *service = game.GetPlanningService();
+    if (service == nullptr) {
+      // Planned on this thread within the ticks, so there is no latency
+      // or staleness to report
+      std::cout << "ai plans: " << plans.inline_plans
+                << " (inline, on the game thread)\n";
+    } else {
+      std::cout << "ai plans: " << plans.delivered << " (" << plans.partial
+                << " partial, " << plans.cancelled << " cancelled)\n";
+      std::cout << "plan latency: mean " << plans.MeanLatencyMs()
+                << " ms, max " << plans.max_latency_ms << " ms\n";
+      std::cout << "plan staleness: mean " << plans.MeanStaleness()
+                << ", max " << plans.max_staleness << " snapshots\n";
+      PlanningService::Stats requests = service->GetStats();
+      std::cout << "planning service: " << service->Threads()
+                << " threads, " << requests.submitted << " requests ("
+                << requests.coalesced << " coalesced), " << requests.served
+                << " served\n";
+    }
+  }
+
+  if (!trace_file.empty()) {
+    Profiler::FrameStats stats = profiler.GetFrameStats();
+    std::cout << "tick time: p50 " << stats.p50_ms << " ms, p95 "
+              << stats.p95_ms << " ms, p99 " << stats.p99_ms << " ms, max "
+              << stats.max_ms << " ms\n";
+    if (!profiler.WriteChromeTrace(trace_file)) {
+      std::cerr << "could not write " << trace_file << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
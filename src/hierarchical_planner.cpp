@@ -0,0 +1,591 @@
+#include "hierarchical_planner.h"
+#include <algorithm>
+#include <cstdlib>
+
+HierarchicalPlanner::HierarchicalPlanner(int grid_width, int grid_height,
+                                         int cluster_size)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      cluster_size_(cluster_size),
+      clusters_x_((grid_width + cluster_size - 1) / cluster_size),
+      clusters_y_((grid_height + cluster_size - 1) / cluster_size) {
+  clusters_.resize(static_cast<std::size_t>(clusters_x_) * clusters_y_);
+  std::size_t local_cells =
+      static_cast<std::size_t>(cluster_size_) * cluster_size_;
+  local_distance_.assign(local_cells, kUnreachable);
+  local_queue_.reserve(local_cells);
+  frontier_.resize(static_cast<std::size_t>(cluster_size_));
+  next_frontier_.resize(static_cast<std::size_t>(cluster_size_));
+  seen_.resize(static_cast<std::size_t>(cluster_size_));
+}
+
+void HierarchicalPlanner::Bounds(int c, int& x0, int& y0, int& x1,
+                                 int& y1) const {
+  x0 = (c % clusters_x_) * cluster_size_;
+  y0 = (c / clusters_x_) * cluster_size_;
+  x1 = std::min(x0 + cluster_size_, grid_width_);
+  y1 = std::min(y0 + cluster_size_, grid_height_);
+}
+
+int HierarchicalPlanner::NeighborCluster(int c, int d) const {
+  int cx = c % clusters_x_;
+  int cy = c / clusters_x_;
+  switch (d) {
+    case 0: cx = cx + 1 == clusters_x_ ? 0 : cx + 1; break;
+    case 1: cx = cx == 0 ? clusters_x_ - 1 : cx - 1; break;
+    case 2: cy = cy + 1 == clusters_y_ ? 0 : cy + 1; break;
+    default: cy = cy == 0 ? clusters_y_ - 1 : cy - 1; break;
+  }
+  return cy * clusters_x_ + cx;
+}
+
+void HierarchicalPlanner::MarkDirty(int c) {
+  if (clusters_[c].dirty) return;
+  clusters_[c].dirty = true;
+  dirty_.push_back(c);
+}
+
+void HierarchicalPlanner::MarkCellDirty(const OccupancyGrid& world, int x,
+                                        int y) {
+  // Food coming and going, or a cell blocked by one layer for another,
+  // changes nothing here
+  int c = ClusterOf(x, y);
+  if (IsOpen(c, {x, y}) != world.IsBlocked(x, y)) return;
+  MarkDirty(c);
+
+  // A border cell also decides the entrances of the cluster across it
+  int x0, y0, x1, y1;
+  Bounds(c, x0, y0, x1, y1);
+  if (x == x1 - 1) MarkDirty(NeighborCluster(c, 0));
+  if (x == x0) MarkDirty(NeighborCluster(c, 1));
+  if (y == y1 - 1) MarkDirty(NeighborCluster(c, 2));
+  if (y == y0) MarkDirty(NeighborCluster(c, 3));
+}
+
+void HierarchicalPlanner::Sync(const OccupancyGrid& world) {
+  rebuilt_ = 0;
+  if (!synced_) {
+    for (int c = 0; c < static_cast<int>(clusters_.size()); ++c) MarkDirty(c);
+    synced_ = true;
+  } else if (world.Version() != seen_version_) {
+    bool journaled = world.ForEachChangeSince(
+        seen_version_, [&](int x, int y) { MarkCellDirty(world, x, y); });
+    if (!journaled) {
+      for (int c = 0; c < static_cast<int>(clusters_.size()); ++c) {
+        MarkDirty(c);
+      }
+    }
+  }
+  seen_version_ = world.Version();
+  if (!dirty_.empty()) RebuildDirty(world);
+}
+
+void HierarchicalPlanner::RebuildDirty(const OccupancyGrid& world) {
+  rebuilt_ = dirty_.size();
+  for (int c : dirty_) BuildCluster(world, c);
+
+  // Links into a rebuilt cluster go stale on both sides of its borders
+  for (int c : dirty_) {
+    LinkCluster(c);
+    for (int d = 0; d < 4; ++d) {
+      int neighbor = NeighborCluster(c, d);
+      if (!clusters_[neighbor].dirty) LinkCluster(neighbor);
+    }
+  }
+  for (int c : dirty_) clusters_[c].dirty = false;
+  dirty_.clear();
+
+  // Room for every node plus the start and goal of a plan
+  std::size_t size = nodes_.size() + 2;
+  if (g_cost_.size() < size) {
+    g_cost_.resize(size);
+    f_cost_.resize(size);
+    parent_.resize(size);
+    heap_pos_.resize(size);
+    stamp_.resize(size, 0);
+    heap_.reserve(size);
+  }
+}
+
+void HierarchicalPlanner::BuildCluster(const OccupancyGrid& world, int c) {
+  Cluster& cluster = clusters_[c];
+  for (int id : cluster.nodes) free_nodes_.push_back(id);
+  cluster.nodes.clear();
+
+  int x0, y0, x1, y1;
+  Bounds(c, x0, y0, x1, y1);
+  cluster.open.assign(static_cast<std::size_t>(y1 - y0), 0);
+  for (int y = y0; y < y1; ++y) {
+    for (int x = x0; x < x1; ++x) {
+      if (!world.IsBlocked(x, y)) {
+        cluster.open[y - y0] |= std::uint64_t{1} << (x - x0);
+      }
+    }
+  }
+
+  int right = x1 == grid_width_ ? 0 : x1;
+  int left = x0 == 0 ? grid_width_ - 1 : x0 - 1;
+  int below = y1 == grid_height_ ? 0 : y1;
+  int above = y0 == 0 ? grid_height_ - 1 : y0 - 1;
+
+  // Each side: the cell on this side of the border at position k along it,
+  // and the cell facing it across the border
+  for (int d = 0; d < 4; ++d) {
+    bool vertical = d < 2;  // the border runs along y
+    int length = vertical ? y1 - y0 : x1 - x0;
+    auto inside = [&](int k) -> SDL_Point {
+      switch (d) {
+        case 0: return {x1 - 1, y0 + k};
+        case 1: return {x0, y0 + k};
+        case 2: return {x0 + k, y1 - 1};
+        default: return {x0 + k, y0};
+      }
+    };
+    auto outside = [&](int k) -> SDL_Point {
+      switch (d) {
+        case 0: return {right, y0 + k};
+        case 1: return {left, y0 + k};
+        case 2: return {x0 + k, below};
+        default: return {x0 + k, above};
+      }
+    };
+    auto open = [&](int k) {
+      SDL_Point a = inside(k);
+      SDL_Point b = outside(k);
+      return IsOpen(c, a) && !world.IsBlocked(b.x, b.y);
+    };
+
+    // Both clusters scan the shared border in the same order, so they
+    // agree on where its entrances are
+    int k = 0;
+    while (k < length) {
+      if (!open(k)) {
+        k++;
+        continue;
+      }
+      int first = k;
+      while (k < length && open(k)) k++;
+      int last = k - 1;
+      if (last - first + 1 >= kLongEntrance) {
+        AddEntrance(c, inside(first));
+        AddEntrance(c, inside(last));
+      } else {
+        AddEntrance(c, inside((first + last) / 2));
+      }
+    }
+  }
+
+  // Distances between entrances within the cluster; symmetric, so one
+  // wavefront per entrance fills its row and column
+  std::size_t n = cluster.nodes.size();
+  cluster.distance.assign(n * n, kUnreachable);
+  for (std::size_t i = 0; i < n; ++i) {
+    cluster.distance[i * n + i] = 0;
+    if (i + 1 == n) break;
+    targets_.clear();
+    for (std::size_t j = i + 1; j < n; ++j) {
+      targets_.push_back(nodes_[cluster.nodes[j]].cell);
+    }
+    Wavefront(c, nodes_[cluster.nodes[i]].cell);
+    for (std::size_t j = i + 1; j < n; ++j) {
+      int distance = target_distance_[j - i - 1];
+      cluster.distance[i * n + j] = distance;
+      cluster.distance[j * n + i] = distance;
+    }
+  }
+}
+
+void HierarchicalPlanner::AddEntrance(int c, SDL_Point cell) {
+  Cluster& cluster = clusters_[c];
+  // A corner cell may be an entrance on two sides
+  for (int id : cluster.nodes) {
+    if (nodes_[id].cell.x == cell.x && nodes_[id].cell.y == cell.y) return;
+  }
+
+  int id;
+  if (!free_nodes_.empty()) {
+    id = free_nodes_.back();
+    free_nodes_.pop_back();
+  } else {
+    id = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+  }
+  Node& node = nodes_[id];
+  node.cell = cell;
+  node.cluster = c;
+  node.slot = static_cast<int>(cluster.nodes.size());
+  std::fill(std::begin(node.across), std::end(node.across), -1);
+  cluster.nodes.push_back(id);
+}
+
+void HierarchicalPlanner::LinkCluster(int c) {
+  int x0, y0, x1, y1;
+  Bounds(c, x0, y0, x1, y1);
+  for (int id : clusters_[c].nodes) {
+    Node& node = nodes_[id];
+    const bool on_edge[4] = {node.cell.x == x1 - 1, node.cell.x == x0,
+                             node.cell.y == y1 - 1, node.cell.y == y0};
+    SDL_Point facing[4];
+    Neighbors(node.cell, facing);
+    for (int d = 0; d < 4; ++d) {
+      node.across[d] = -1;
+      if (!on_edge[d]) continue;
+      for (int other : clusters_[NeighborCluster(c, d)].nodes) {
+        if (nodes_[other].cell.x == facing[d].x &&
+            nodes_[other].cell.y == facing[d].y) {
+          node.across[d] = other;
+          break;
+        }
+      }
+    }
+  }
+}
+
+bool HierarchicalPlanner::IsOpen(int c, SDL_Point cell) const {
+  int x0, y0, x1, y1;
+  Bounds(c, x0, y0, x1, y1);
+  return (clusters_[c].open[cell.y - y0] >> (cell.x - x0)) & 1;
+}
+
+void HierarchicalPlanner::Wavefront(int c, SDL_Point from) {
+  int x0, y0, x1, y1;
+  Bounds(c, x0, y0, x1, y1);
+  const std::vector<std::uint64_t>& open = clusters_[c].open;
+  const int rows = y1 - y0;
+  std::fill_n(frontier_.begin(), rows, 0);
+  std::fill_n(seen_.begin(), rows, 0);
+  frontier_[from.y - y0] = seen_[from.y - y0] = std::uint64_t{1}
+                                                << (from.x - x0);
+
+  std::size_t remaining = targets_.size();
+  target_distance_.assign(targets_.size(), kUnreachable);
+  for (std::size_t j = 0; j < targets_.size(); ++j) {
+    if (targets_[j].x == from.x && targets_[j].y == from.y) {
+      target_distance_[j] = 0;
+      remaining--;
+    }
+  }
+
+  for (int step = 1; remaining > 0; ++step) {
+    // Every open cell next to the frontier and not yet seen; bits shifted
+    // past the cluster's width are masked off by `open`
+    std::uint64_t grew = 0;
+    for (int r = 0; r < rows; ++r) {
+      std::uint64_t around = frontier_[r] << 1 | frontier_[r] >> 1;
+      if (r > 0) around |= frontier_[r - 1];
+      if (r + 1 < rows) around |= frontier_[r + 1];
+      next_frontier_[r] = around & open[r] & ~seen_[r];
+      grew |= next_frontier_[r];
+    }
+    if (grew == 0) break;
+    for (int r = 0; r < rows; ++r) {
+      frontier_[r] = next_frontier_[r];
+      seen_[r] |= frontier_[r];
+    }
+    for (std::size_t j = 0; j < targets_.size(); ++j) {
+      if (target_distance_[j] == kUnreachable &&
+          ((frontier_[targets_[j].y - y0] >> (targets_[j].x - x0)) & 1)) {
+        target_distance_[j] = step;
+        remaining--;
+      }
+    }
+  }
+}
+
+void HierarchicalPlanner::LocalSearch(int c, SDL_Point from) {
+  int x0, y0, x1, y1;
+  Bounds(c, x0, y0, x1, y1);
+  const std::vector<std::uint64_t>& open = clusters_[c].open;
+  std::fill(local_distance_.begin(), local_distance_.end(), kUnreachable);
+  local_queue_.clear();
+
+  auto local = [&](int x, int y) { return (y - y0) * cluster_size_ + x - x0; };
+  local_distance_[local(from.x, from.y)] = 0;
+  local_queue_.push_back(local(from.x, from.y));
+  for (std::size_t head = 0; head < local_queue_.size(); ++head) {
+    int cell = local_queue_[head];
+    int x = x0 + cell % cluster_size_;
+    int y = y0 + cell / cluster_size_;
+    int distance = local_distance_[cell] + 1;
+    const SDL_Point neighbors[4] = {{x + 1, y}, {x - 1, y}, {x, y + 1},
+                                    {x, y - 1}};
+    for (const SDL_Point& next : neighbors) {
+      if (next.x < x0 || next.x >= x1 || next.y < y0 || next.y >= y1) {
+        continue;
+      }
+      int index = local(next.x, next.y);
+      if (local_distance_[index] != kUnreachable ||
+          !((open[next.y - y0] >> (next.x - x0)) & 1)) {
+        continue;
+      }
+      local_distance_[index] = distance;
+      local_queue_.push_back(index);
+    }
+  }
+}
+
+int HierarchicalPlanner::LocalDistance(int c, SDL_Point cell) const {
+  int x0, y0, x1, y1;
+  Bounds(c, x0, y0, x1, y1);
+  return local_distance_[(cell.y - y0) * cluster_size_ + cell.x - x0];
+}
+
+int HierarchicalPlanner::Heuristic(SDL_Point a, SDL_Point b) const {
+  int dx = std::abs(a.x - b.x);
+  int dy = std::abs(a.y - b.y);
+  return std::min(dx, grid_width_ - dx) + std::min(dy, grid_height_ - dy);
+}
+
+SDL_Point HierarchicalPlanner::CellOf(int node) const {
+  if (node == start_id_) return start_;
+  if (node == goal_id_) return goal_;
+  return nodes_[node].cell;
+}
+
+bool HierarchicalPlanner::PlanAbstract(const OccupancyGrid& world,
+                                       SDL_Point start, SDL_Point goal) {
+  Sync(world);
+  waypoints_.clear();
+  plan_length_ = 0;
+  expanded_ = 0;
+  if (world.IsBlocked(goal.x, goal.y)) return false;
+
+  // Join the start and goal to the entrances of their clusters
+  start_ = start;
+  goal_ = goal;
+  start_cluster_ = ClusterOf(start.x, start.y);
+  goal_cluster_ = ClusterOf(goal.x, goal.y);
+  ConnectStart();
+  targets_.clear();
+  for (int id : clusters_[goal_cluster_].nodes) {
+    targets_.push_back(nodes_[id].cell);
+  }
+  Wavefront(goal_cluster_, goal);
+  goal_distance_.assign(target_distance_.begin(), target_distance_.end());
+
+  start_id_ = static_cast<int>(nodes_.size());
+  goal_id_ = start_id_ + 1;
+  NextGeneration();
+  heap_.clear();
+  stamp_[start_id_] = generation_;
+  g_cost_[start_id_] = 0;
+  f_cost_[start_id_] = Heuristic(start, goal);
+  parent_[start_id_] = -1;
+  HeapPush(start_id_);
+
+  while (!heap_.empty()) {
+    int current = HeapPop();
+    heap_pos_[current] = kClosed;
+    expanded_++;
+    int g = g_cost_[current];
+
+    if (current == goal_id_) {
+      plan_length_ = g;
+      for (int node = goal_id_; node != -1; node = parent_[node]) {
+        SDL_Point cell = CellOf(node);
+        // The start or goal may itself sit on an entrance
+        if (!waypoints_.empty() && waypoints_.back().x == cell.x &&
+            waypoints_.back().y == cell.y) {
+          continue;
+        }
+        waypoints_.push_back(cell);
+      }
+      std::reverse(waypoints_.begin(), waypoints_.end());
+      return true;
+    }
+
+    if (current == start_id_) {
+      for (const auto& edge : start_edges_) {
+        Relax(edge.first, current, g + edge.second, goal);
+      }
+      if (direct_distance_ != kUnreachable) {
+        Relax(goal_id_, current, g + direct_distance_, goal);
+      }
+      continue;
+    }
+
+    const Node& node = nodes_[current];
+    const Cluster& cluster = clusters_[node.cluster];
+    std::size_t n = cluster.nodes.size();
+    const int *row = &cluster.distance[node.slot * n];
+    for (std::size_t j = 0; j < n; ++j) {
+      if (row[j] > 0) Relax(cluster.nodes[j], current, g + row[j], goal);
+    }
+    for (int other : node.across) {
+      if (other != -1) Relax(other, current, g + 1, goal);
+    }
+    if (node.cluster == goal_cluster_ &&
+        goal_distance_[node.slot] != kUnreachable) {
+      Relax(goal_id_, current, g + goal_distance_[node.slot], goal);
+    }
+  }
+  return false;
+}
+
+void HierarchicalPlanner::ConnectStart() {
+  start_edges_.clear();
+  direct_distance_ = kUnreachable;
+  auto connect = [&](int c, SDL_Point from, int offset) {
+    const std::vector<int>& ids = clusters_[c].nodes;
+    targets_.clear();
+    for (int id : ids) targets_.push_back(nodes_[id].cell);
+    if (c == goal_cluster_) targets_.push_back(goal_);
+    Wavefront(c, from);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      if (target_distance_[i] != kUnreachable) {
+        start_edges_.emplace_back(ids[i], offset + target_distance_[i]);
+      }
+    }
+    if (c == goal_cluster_) {
+      int distance = target_distance_.back();
+      if (distance != kUnreachable &&
+          (direct_distance_ == kUnreachable ||
+           offset + distance < direct_distance_)) {
+        direct_distance_ = offset + distance;
+      }
+    }
+  };
+  connect(start_cluster_, start_, 0);
+
+  // A free start on a border lies on an open stretch with an entrance, but
+  // a blocked one (a snake's own head) may only get out by stepping across
+  SDL_Point neighbors[4];
+  Neighbors(start_, neighbors);
+  for (const SDL_Point& next : neighbors) {
+    int c = ClusterOf(next.x, next.y);
+    if (c != start_cluster_ && IsOpen(c, next)) {
+      connect(c, next, 1);
+    }
+  }
+}
+
+void HierarchicalPlanner::Neighbors(SDL_Point cell,
+                                    SDL_Point (&out)[4]) const {
+  out[0] = {cell.x + 1 == grid_width_ ? 0 : cell.x + 1, cell.y};
+  out[1] = {cell.x == 0 ? grid_width_ - 1 : cell.x - 1, cell.y};
+  out[2] = {cell.x, cell.y + 1 == grid_height_ ? 0 : cell.y + 1};
+  out[3] = {cell.x, cell.y == 0 ? grid_height_ - 1 : cell.y - 1};
+}
+
+void HierarchicalPlanner::Relax(int node, int from, int g, SDL_Point goal) {
+  if (stamp_[node] != generation_) {
+    stamp_[node] = generation_;
+    g_cost_[node] = g;
+    f_cost_[node] = g + Heuristic(CellOf(node), goal);
+    parent_[node] = from;
+    HeapPush(node);
+  } else if (heap_pos_[node] != kClosed && g < g_cost_[node]) {
+    f_cost_[node] -= g_cost_[node] - g;
+    g_cost_[node] = g;
+    parent_[node] = from;
+    SiftUp(static_cast<std::size_t>(heap_pos_[node]));
+  }
+}
+
+bool HierarchicalPlanner::RefineSegment(const OccupancyGrid& world,
+                                        std::size_t i,
+                                        std::vector<SDL_Point>& path) {
+  SDL_Point cell = waypoints_[i];
+  SDL_Point b = waypoints_[i + 1];
+
+  // The far end's cluster holds the whole segment, apart from a first step
+  // across its border (between entrances, or off a blocked start). Search
+  // it from b, then walk from a down the distances.
+  Sync(world);
+  int c = ClusterOf(b.x, b.y);
+  LocalSearch(c, b);
+  int distance = kUnreachable;
+  while (distance != 0) {
+    SDL_Point neighbors[4];
+    Neighbors(cell, neighbors);
+    int best = kUnreachable;
+    for (const SDL_Point& next : neighbors) {
+      if (ClusterOf(next.x, next.y) != c) continue;
+      int d = LocalDistance(c, next);
+      if (d == kUnreachable || (distance != kUnreachable && d >= distance) ||
+          (best != kUnreachable && d >= best)) {
+        continue;
+      }
+      best = d;
+      cell = next;
+    }
+    if (best == kUnreachable) return false;
+    distance = best;
+    path.push_back(cell);
+  }
+  return true;
+}
+
+bool HierarchicalPlanner::FindPath(const OccupancyGrid& world,
+                                   SDL_Point start, SDL_Point goal,
+                                   std::vector<SDL_Point>& path) {
+  path.clear();
+  if (!PlanAbstract(world, start, goal)) return false;
+  for (std::size_t i = 0; i + 1 < waypoints_.size(); ++i) {
+    if (!RefineSegment(world, i, path)) {
+      path.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+void HierarchicalPlanner::NextGeneration() {
+  generation_++;
+  if (generation_ == 0) {
+    std::fill(stamp_.begin(), stamp_.end(), 0);
+    generation_ = 1;
+  }
+}
+
+bool HierarchicalPlanner::HeapLess(int a, int b) const {
+  if (f_cost_[a] != f_cost_[b]) return f_cost_[a] < f_cost_[b];
+  return g_cost_[a] > g_cost_[b];
+}
+
+void HierarchicalPlanner::HeapPush(int node) {
+  heap_.push_back(node);
+  heap_pos_[node] = static_cast<int>(heap_.size() - 1);
+  SiftUp(heap_.size() - 1);
+}
+
+int HierarchicalPlanner::HeapPop() {
+  int top = heap_.front();
+  int last = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty()) {
+    heap_[0] = last;
+    heap_pos_[last] = 0;
+    SiftDown(0);
+  }
+  return top;
+}
+
+void HierarchicalPlanner::SiftUp(std::size_t pos) {
+  int node = heap_[pos];
+  while (pos > 0) {
+    std::size_t parent = (pos - 1) / 2;
+    if (!HeapLess(node, heap_[parent])) break;
+    heap_[pos] = heap_[parent];
+    heap_pos_[heap_[pos]] = static_cast<int>(pos);
+    pos = parent;
+  }
+  heap_[pos] = node;
+  heap_pos_[node] = static_cast<int>(pos);
+}
+
+void HierarchicalPlanner::SiftDown(std::size_t pos) {
+  int node = heap_[pos];
+  std::size_t size = heap_.size();
+  while (true) {
+    std::size_t child = 2 * pos + 1;
+    if (child >= size) break;
+    if (child + 1 < size && HeapLess(heap_[child + 1], heap_[child])) child++;
+    if (!HeapLess(heap_[child], node)) break;
+    heap_[pos] = heap_[child];
+    heap_pos_[heap_[pos]] = static_cast<int>(pos);
+    pos = child;
+  }
+  heap_[pos] = node;
+  heap_pos_[node] = static_cast<int>(pos);
+}
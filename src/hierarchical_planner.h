@@ -0,0 +1,195 @@
+#ifndef HIERARCHICAL_PLANNER_H
+#define HIERARCHICAL_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "SDL.h"
+#include "occupancy_grid.h"
+
+// HPA*-style planning for grids too large to search cell by cell. The grid
+// is cut into square clusters. Where two neighbouring clusters share an
+// open stretch of border, one or two entrance cells are placed on each
+// side, and the distances between every pair of entrances within a cluster
+// are precomputed. A plan is then an A* search over this small graph of
+// entrances, with the start and goal joined to their own cluster's
+// entrances for the duration of the search. The result is a list of
+// waypoints, and the cells between two waypoints are filled in only when
+// asked for, one cluster at a time.
+//
+// Each cluster keeps its open cells as a small bitboard, one word per row,
+// and distances within it are measured by growing a wavefront over the
+// bitboard a row at a time. Clusters are kept current through the grid's
+// change journal: a cell that becomes blocked or free dirties its own
+// cluster, plus the neighbouring cluster when the cell lies on their shared
+// border, and only those clusters are rebuilt before the next plan. Like
+// IncrementalPlanner, this expects successive calls to see one world (or
+// copies of it) as it evolves. Paths are close to, but not always exactly,
+// the shortest.
+class HierarchicalPlanner {
+ public:
+  static constexpr int kClusterSize = 16;
+
+  // cluster_size is at most 64, the width of a bitboard row
+  HierarchicalPlanner(int grid_width, int grid_height,
+                      int cluster_size = kClusterSize);
+
+  // Rebuild the clusters that changed since the last call
+  void Sync(const OccupancyGrid& world);
+
+  // Plan from start to goal across clusters. On success the waypoints
+  // (start, each entrance the plan passes through, goal) are available from
+  // Waypoints() and true is returned.
+  bool PlanAbstract(const OccupancyGrid& world, SDL_Point start,
+                    SDL_Point goal);
+
+  const std::vector<SDL_Point>& Waypoints() const { return waypoints_; }
+  // Length in cells of the last plan
+  int PlanLength() const { return plan_length_; }
+
+  // Append the cells leading from waypoint i to waypoint i + 1 (excluding
+  // waypoint i) to `path`. False if the world has since cut them apart.
+  bool RefineSegment(const OccupancyGrid& world, std::size_t i,
+                     std::vector<SDL_Point>& path);
+
+  // Plan and refine every segment. On success the path (excluding start,
+  // ending at goal) is written into `path` and true is returned; `path` is
+  // left empty if goal is unreachable.
+  bool FindPath(const OccupancyGrid& world, SDL_Point start, SDL_Point goal,
+                std::vector<SDL_Point>& path);
+
+  // Abstract nodes expanded by the most recent plan
+  std::size_t Expanded() const { return expanded_; }
+  // Clusters rebuilt by the most recent Sync
+  std::size_t RebuiltClusters() const { return rebuilt_; }
+
+  int Width() const { return grid_width_; }
+  int Height() const { return grid_height_; }
+
+ private:
+  static constexpr int kUnreachable = -1;
+  static constexpr int kClosed = -1;
+  // Open border stretches at least this long get an entrance at each end
+  static constexpr int kLongEntrance = 6;
+
+  // An entrance cell. across[d] is the entrance one step away in
+  // neighbouring cluster in direction d (+x, -x, +y, -y), or -1.
+  struct Node {
+    SDL_Point cell;
+    int cluster;
+    int slot;  // index within its cluster's nodes
+    int across[4];
+  };
+
+  // Entrances of one cluster, the distances between them within it,
+  // row-major by slot (kUnreachable where none), and its open cells as of
+  // the last rebuild, bit x - x0 of word y - y0
+  struct Cluster {
+    std::vector<int> nodes;
+    std::vector<int> distance;
+    std::vector<std::uint64_t> open;
+    bool dirty{false};
+  };
+
+  int ClusterOf(int x, int y) const {
+    return (y / cluster_size_) * clusters_x_ + x / cluster_size_;
+  }
+  // Cells of cluster c span [x0, x1) x [y0, y1)
+  void Bounds(int c, int& x0, int& y0, int& x1, int& y1) const;
+  // The cluster next to c in direction d, wrapping
+  int NeighborCluster(int c, int d) const;
+
+  void MarkDirty(int c);
+  // Dirty what a journaled cell affects, if it became blocked or free
+  void MarkCellDirty(const OccupancyGrid& world, int x, int y);
+  void RebuildDirty(const OccupancyGrid& world);
+  // Place the entrances on cluster c's side of its four borders and
+  // measure the distances between them
+  void BuildCluster(const OccupancyGrid& world, int c);
+  void AddEntrance(int c, SDL_Point cell);
+  void LinkCluster(int c);
+
+  // Join the start to the entrances of its own cluster and, through each
+  // free neighbour across a border, of that cluster
+  void ConnectStart();
+  // Neighbours of a cell in order +x, -x, +y, -y, wrapping
+  void Neighbors(SDL_Point cell, SDL_Point (&out)[4]) const;
+
+  bool IsOpen(int c, SDL_Point cell) const;
+
+  // Distances within cluster c from `from` to each of targets_, into
+  // target_distance_, found by growing a wavefront over the cluster's
+  // bitboard until every target is reached or it stops growing. `from`
+  // itself may be blocked.
+  void Wavefront(int c, SDL_Point from);
+  // Breadth-first search from `from` confined to cluster c, filling
+  // local_distance_ for every cell; `from` itself may be blocked
+  void LocalSearch(int c, SDL_Point from);
+  int LocalDistance(int c, SDL_Point cell) const;
+
+  // Manhattan distance on the torus
+  int Heuristic(SDL_Point a, SDL_Point b) const;
+
+  void NextGeneration();
+  void Relax(int node, int from, int g, SDL_Point goal);
+  SDL_Point CellOf(int node) const;
+
+  // Binary min-heap keyed on (f, -g), as in PathPlanner
+  bool HeapLess(int a, int b) const;
+  void HeapPush(int node);
+  int HeapPop();
+  void SiftUp(std::size_t pos);
+  void SiftDown(std::size_t pos);
+
+  int grid_width_;
+  int grid_height_;
+  int cluster_size_;
+  int clusters_x_;
+  int clusters_y_;
+
+  std::vector<Node> nodes_;
+  std::vector<int> free_nodes_;
+  std::vector<Cluster> clusters_;
+  std::vector<int> dirty_;
+  bool synced_{false};
+  std::uint64_t seen_version_{0};
+  std::size_t rebuilt_{0};
+
+  // Scratch for searches within one cluster
+  std::vector<SDL_Point> targets_;
+  std::vector<int> target_distance_;
+  std::vector<std::uint64_t> frontier_;
+  std::vector<std::uint64_t> next_frontier_;
+  std::vector<std::uint64_t> seen_;
+  std::vector<int> local_distance_;
+  std::vector<int> local_queue_;
+
+  // Abstract search state, indexed by node; the start and goal take the
+  // two ids past the last node while a plan runs
+  std::vector<int> g_cost_;
+  std::vector<int> f_cost_;
+  std::vector<int> parent_;
+  std::vector<int> heap_pos_;
+  std::vector<std::uint32_t> stamp_;
+  std::vector<int> heap_;
+  std::uint32_t generation_{0};
+  int start_id_{0};
+  int goal_id_{0};
+  SDL_Point start_{0, 0};
+  SDL_Point goal_{0, 0};
+  int start_cluster_{0};
+  int goal_cluster_{0};
+  // Entrances the start reaches without crossing another (id, distance),
+  // distances from the goal's cluster's entrances to the goal by slot, and
+  // the distance from start to goal without crossing an entrance
+  std::vector<std::pair<int, int>> start_edges_;
+  std::vector<int> goal_distance_;
+  int direct_distance_{kUnreachable};
+
+  std::vector<SDL_Point> waypoints_;
+  int plan_length_{0};
+  std::size_t expanded_{0};
+};
+
+#endif
@@ -0,0 +1,321 @@
+#include "incremental_planner.h"
+#include <algorithm>
+
+IncrementalPlanner::IncrementalPlanner(int grid_width, int grid_height)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      geometry_(grid_width, grid_height) {
+  std::size_t cells = static_cast<std::size_t>(grid_width) * grid_height;
+  g_.resize(cells);
+  rhs_.resize(cells);
+  key_.resize(cells);
+  heap_pos_.resize(cells);
+  stamp_.assign(cells, 0);
+  blocked_.assign(cells, 0);
+  goal_.assign(cells, 0);
+  heap_.reserve(cells);
+}
+
+bool IncrementalPlanner::FindPath(const OccupancyGrid& world, SDL_Point start,
+                                  SDL_Point goal,
+                                  std::vector<SDL_Point>& path) {
+  Target target{false, goal.y * grid_width_ + goal.x,
+                OccupancyGrid::Layer::kFood};
+  return Plan(world, start, target, path);
+}
+
+bool IncrementalPlanner::FindPath(const OccupancyGrid& world, SDL_Point start,
+                                  OccupancyGrid::Layer targets,
+                                  std::vector<SDL_Point>& path) {
+  return Plan(world, start, Target{true, 0, targets}, path);
+}
+
+bool IncrementalPlanner::Plan(const OccupancyGrid& world, SDL_Point start,
+                              Target target, std::vector<SDL_Point>& path) {
+  path.clear();
+  expanded_ = 0;
+  changed_ = 0;
+
+  int start_cell = start.y * grid_width_ + start.x;
+  start_ = start_cell;
+
+  if (!has_tree_ || !(target == target_)) {
+    Initialize(world, target);
+  } else {
+    // Keys already queued were computed against the old start; rather than
+    // re-keying the heap, raise every future key by how far start moved
+    key_modifier_ += Heuristic(last_start_, start_cell);
+    if (!ApplyChanges(world)) Initialize(world, target);
+  }
+  last_start_ = start_cell;
+
+  ComputeShortestPath();
+  return ExtractPath(path);
+}
+
+int IncrementalPlanner::Heuristic(int a, int b) const {
+  return geometry_.Distance(geometry_.X(a), geometry_.Y(a), geometry_.X(b),
+                            geometry_.Y(b));
+}
+
+void IncrementalPlanner::NextGeneration() {
+  generation_++;
+  if (generation_ == 0) {
+    std::fill(stamp_.begin(), stamp_.end(), 0);
+    generation_ = 1;
+  }
+}
+
+void IncrementalPlanner::Touch(int cell) {
+  if (stamp_[cell] == generation_) return;
+  stamp_[cell] = generation_;
+  g_[cell] = kInfinity;
+  rhs_[cell] = kInfinity;
+  heap_pos_[cell] = kNotQueued;
+}
+
+void IncrementalPlanner::Neighbors(int cell, int (&out)[4]) const {
+  int x = geometry_.X(cell);
+  int y = geometry_.Y(cell);
+  out[0] = geometry_.Cell(geometry_.Right(x), y);
+  out[1] = geometry_.Cell(geometry_.Left(x), y);
+  out[2] = geometry_.Cell(x, geometry_.Down(y));
+  out[3] = geometry_.Cell(x, geometry_.Up(y));
+}
+
+IncrementalPlanner::Key IncrementalPlanner::CalculateKey(int cell) const {
+  int best = std::min(G(cell), Rhs(cell));
+  if (best >= kInfinity) return Key{kInfinity, kInfinity};
+  return Key{best + Heuristic(start_, cell) + key_modifier_, best};
+}
+
+void IncrementalPlanner::UpdateRhs(int cell) {
+  if (goal_[cell]) return;
+  int neighbors[4];
+  Neighbors(cell, neighbors);
+  int best = kInfinity;
+  for (int next : neighbors) {
+    best = std::min(best, CostVia(next));
+  }
+  Touch(cell);
+  rhs_[cell] = best;
+}
+
+void IncrementalPlanner::UpdateVertex(int cell) {
+  Touch(cell);
+  bool queued = heap_pos_[cell] != kNotQueued;
+  if (g_[cell] != rhs_[cell]) {
+    if (queued) {
+      HeapUpdate(cell, CalculateKey(cell));
+    } else {
+      HeapPush(cell, CalculateKey(cell));
+    }
+  } else if (queued) {
+    HeapRemove(cell);
+  }
+}
+
+void IncrementalPlanner::ComputeShortestPath() {
+  Touch(start_);
+  while (!heap_.empty()) {
+    int top = heap_.front();
+    Key start_key = CalculateKey(start_);
+    if (!(key_[top] < start_key) && rhs_[start_] <= g_[start_]) break;
+
+    Key old_key = key_[top];
+    Key new_key = CalculateKey(top);
+    if (old_key < new_key) {
+      // Queued before start moved; requeue with its up-to-date key
+      HeapUpdate(top, new_key);
+      continue;
+    }
+
+    expanded_++;
+    int neighbors[4];
+    Neighbors(top, neighbors);
+    if (g_[top] > rhs_[top]) {
+      // Overconsistent: settle it and offer the improvement to neighbours
+      g_[top] = rhs_[top];
+      HeapRemove(top);
+      int via = blocked_[top] ? kInfinity : g_[top] + 1;
+      for (int prev : neighbors) {
+        if (goal_[prev]) continue;
+        Touch(prev);
+        if (via < rhs_[prev]) {
+          rhs_[prev] = via;
+          UpdateVertex(prev);
+        }
+      }
+    } else {
+      // Underconsistent: a route through it got worse, so everything that
+      // relied on it has to look again
+      g_[top] = kInfinity;
+      UpdateRhs(top);
+      UpdateVertex(top);
+      for (int prev : neighbors) {
+        UpdateRhs(prev);
+        UpdateVertex(prev);
+      }
+    }
+  }
+}
+
+void IncrementalPlanner::Initialize(const OccupancyGrid& world,
+                                    Target target) {
+  NextGeneration();
+  heap_.clear();
+  has_tree_ = true;
+  target_ = target;
+  reached_goal_ = -1;
+  key_modifier_ = 0;
+  seen_version_ = world.Version();
+
+  // Every goal is a source of the backwards search
+  for (int y = 0; y < grid_height_; ++y) {
+    for (int x = 0; x < grid_width_; ++x) {
+      int cell = y * grid_width_ + x;
+      blocked_[cell] = world.IsBlocked(x, y) ? 1 : 0;
+      goal_[cell] = IsGoalIn(world, x, y) ? 1 : 0;
+      if (goal_[cell]) {
+        Touch(cell);
+        rhs_[cell] = 0;
+        HeapPush(cell, CalculateKey(cell));
+      }
+    }
+  }
+}
+
+bool IncrementalPlanner::ApplyChanges(const OccupancyGrid& world) {
+  // Losing the goal the last path led to invalidates most of the tree,
+  // which costs more to tear down and regrow than a fresh search costs to
+  // grow once. Other goals only own the fringe the search touched.
+  bool lost_goal = false;
+  bool journaled = world.ForEachChangeSince(seen_version_, [&](int x, int y) {
+    int cell = y * grid_width_ + x;
+    if (cell == reached_goal_ && !IsGoalIn(world, x, y)) lost_goal = true;
+  });
+  if (!journaled || lost_goal) return false;
+
+  world.ForEachChangeSince(seen_version_,
+                           [&](int x, int y) { ApplyChange(world, x, y); });
+  seen_version_ = world.Version();
+  return true;
+}
+
+void IncrementalPlanner::ApplyChange(const OccupancyGrid& world, int x,
+                                     int y) {
+  int cell = y * grid_width_ + x;
+  std::uint8_t goal = IsGoalIn(world, x, y) ? 1 : 0;
+  if (goal != goal_[cell]) {
+    // A goal appeared or went away: its own cost-to-goal changes
+    goal_[cell] = goal;
+    changed_++;
+    Touch(cell);
+    if (goal) {
+      rhs_[cell] = 0;
+    } else {
+      UpdateRhs(cell);
+    }
+    UpdateVertex(cell);
+  }
+
+  std::uint8_t blocked = world.IsBlocked(x, y) ? 1 : 0;
+  if (blocked == blocked_[cell]) return;
+  blocked_[cell] = blocked;
+  changed_++;
+
+  // Only the cost of stepping into `cell` changed, which matters to the
+  // neighbours that could step into it
+  int neighbors[4];
+  Neighbors(cell, neighbors);
+  for (int prev : neighbors) {
+    UpdateRhs(prev);
+    UpdateVertex(prev);
+  }
+}
+
+bool IncrementalPlanner::ExtractPath(std::vector<SDL_Point>& path) {
+  if (Rhs(start_) >= kInfinity) return false;
+
+  // Descend the cost-to-goal field, which strictly decreases along the way
+  int cell = start_;
+  std::size_t limit = g_.size();
+  while (!goal_[cell]) {
+    int neighbors[4];
+    Neighbors(cell, neighbors);
+    int best = -1;
+    int best_cost = kInfinity;
+    for (int next : neighbors) {
+      int cost = CostVia(next);
+      if (cost < best_cost) {
+        best = next;
+        best_cost = cost;
+      }
+    }
+    if (best < 0 || path.size() >= limit) {
+      path.clear();
+      return false;
+    }
+    path.push_back({geometry_.X(best), geometry_.Y(best)});
+    cell = best;
+  }
+  reached_goal_ = cell;
+  return true;
+}
+
+void IncrementalPlanner::HeapPush(int cell, Key key) {
+  key_[cell] = key;
+  heap_.push_back(cell);
+  heap_pos_[cell] = static_cast<int>(heap_.size() - 1);
+  SiftUp(heap_.size() - 1);
+}
+
+void IncrementalPlanner::HeapRemove(int cell) {
+  std::size_t pos = static_cast<std::size_t>(heap_pos_[cell]);
+  int last = heap_.back();
+  heap_.pop_back();
+  heap_pos_[cell] = kNotQueued;
+  if (last == cell) return;
+  heap_[pos] = last;
+  heap_pos_[last] = static_cast<int>(pos);
+  SiftUp(pos);
+  SiftDown(static_cast<std::size_t>(heap_pos_[last]));
+}
+
+void IncrementalPlanner::HeapUpdate(int cell, Key key) {
+  key_[cell] = key;
+  std::size_t pos = static_cast<std::size_t>(heap_pos_[cell]);
+  SiftUp(pos);
+  SiftDown(static_cast<std::size_t>(heap_pos_[cell]));
+}
+
+void IncrementalPlanner::SiftUp(std::size_t pos) {
+  int cell = heap_[pos];
+  while (pos > 0) {
+    std::size_t parent = (pos - 1) / 2;
+    if (!(key_[cell] < key_[heap_[parent]])) break;
+    heap_[pos] = heap_[parent];
+    heap_pos_[heap_[pos]] = static_cast<int>(pos);
+    pos = parent;
+  }
+  heap_[pos] = cell;
+  heap_pos_[cell] = static_cast<int>(pos);
+}
+
+void IncrementalPlanner::SiftDown(std::size_t pos) {
+  int cell = heap_[pos];
+  std::size_t size = heap_.size();
+  while (true) {
+    std::size_t child = 2 * pos + 1;
+    if (child >= size) break;
+    if (child + 1 < size && key_[heap_[child + 1]] < key_[heap_[child]]) {
+      child++;
+    }
+    if (!(key_[heap_[child]] < key_[cell])) break;
+    heap_[pos] = heap_[child];
+    heap_pos_[heap_[pos]] = static_cast<int>(pos);
+    pos = child;
+  }
+  heap_[pos] = cell;
+  heap_pos_[cell] = static_cast<int>(pos);
+}
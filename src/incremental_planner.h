@@ -0,0 +1,150 @@
+#ifndef INCREMENTAL_PLANNER_H
+#define INCREMENTAL_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SDL.h"
+#include "grid_geometry.h"
+#include "occupancy_grid.h"
+
+// D* Lite over the wrapping 4-connected grid. The search runs backwards from
+// the goal, so the tree stays valid while the start (the snake's head)
+// moves, and when cells become blocked or free only the affected part of
+// the tree is repaired. Changed cells are found through the grid's change
+// journal, so replanning towards an unchanged goal costs in proportion to
+// what changed, not to the size of the grid; a new goal starts a fresh
+// search. Successive calls are expected to see one world (or copies of it)
+// as it evolves. State lives in flat per-cell arrays with a generation
+// stamp and an intrusive heap, as in PathPlanner.
+//
+// The goal may also be every cell of a layer (all food): the search then
+// floods from all of them at once, and the path leads to whichever is
+// nearest by true path length. Cells joining or leaving the layer are
+// repaired like any other change.
+class IncrementalPlanner {
+ public:
+  IncrementalPlanner(int grid_width, int grid_height);
+
+  // Find a shortest path from start to goal avoiding blocked cells, reusing
+  // the previous search when goal is unchanged. On success the path
+  // (excluding start, ending at goal) is written into `path` and true is
+  // returned; `path` is left empty if goal is unreachable.
+  bool FindPath(const OccupancyGrid& world, SDL_Point start, SDL_Point goal,
+                std::vector<SDL_Point>& path);
+
+  // As above, towards the nearest reachable cell occupied by `targets`
+  bool FindPath(const OccupancyGrid& world, SDL_Point start,
+                OccupancyGrid::Layer targets, std::vector<SDL_Point>& path);
+
+  // Forget the search tree; the next FindPath starts from scratch
+  void Reset() { has_tree_ = false; }
+
+  // Nodes expanded and cells found changed by the most recent FindPath
+  std::size_t Expanded() const { return expanded_; }
+  std::size_t ChangedCells() const { return changed_; }
+
+  int Width() const { return grid_width_; }
+  int Height() const { return grid_height_; }
+
+ private:
+  static constexpr int kInfinity = 1 << 29;
+  static constexpr int kNotQueued = -1;
+
+  struct Key {
+    int primary;
+    int secondary;
+    bool operator<(const Key& other) const {
+      return primary != other.primary ? primary < other.primary
+                                      : secondary < other.secondary;
+    }
+  };
+
+  // Manhattan distance between two cells on the torus
+  int Heuristic(int a, int b) const;
+
+  // Start a new search generation, resetting stamps on wrap-around
+  void NextGeneration();
+  // Lazily initialise a cell's state for the current generation
+  void Touch(int cell);
+  int G(int cell) const {
+    return stamp_[cell] == generation_ ? g_[cell] : kInfinity;
+  }
+  int Rhs(int cell) const {
+    return stamp_[cell] == generation_ ? rhs_[cell] : kInfinity;
+  }
+
+  void Neighbors(int cell, int (&out)[4]) const;
+  // Cost of moving into `cell` from a neighbour and then on to the goal
+  int CostVia(int cell) const {
+    int g = G(cell);
+    return blocked_[cell] || g >= kInfinity ? kInfinity : g + 1;
+  }
+
+  Key CalculateKey(int cell) const;
+  void UpdateRhs(int cell);
+  void UpdateVertex(int cell);
+  void ComputeShortestPath();
+
+  // Which search the current tree belongs to: one cell, or a whole layer
+  struct Target {
+    bool layer_mode;
+    int cell;
+    OccupancyGrid::Layer layer;
+    bool operator==(const Target& other) const {
+      return layer_mode == other.layer_mode &&
+             (layer_mode ? layer == other.layer : cell == other.cell);
+    }
+  };
+  bool IsGoalIn(const OccupancyGrid& world, int x, int y) const {
+    return target_.layer_mode ? world.Has(x, y, target_.layer)
+                              : y * grid_width_ + x == target_.cell;
+  }
+
+  bool Plan(const OccupancyGrid& world, SDL_Point start, Target target,
+            std::vector<SDL_Point>& path);
+  // Restart the search towards `target`
+  void Initialize(const OccupancyGrid& world, Target target);
+  // Bring blocked_ in line with `world`, repairing around changed cells.
+  // Returns false, changing nothing, if a fresh search would be cheaper
+  // (the goal last reached went away, or the grid's journal no longer
+  // reaches back).
+  bool ApplyChanges(const OccupancyGrid& world);
+  void ApplyChange(const OccupancyGrid& world, int x, int y);
+
+  bool ExtractPath(std::vector<SDL_Point>& path);
+
+  // Intrusive binary min-heap on Key
+  void HeapPush(int cell, Key key);
+  void HeapRemove(int cell);
+  void HeapUpdate(int cell, Key key);
+  void SiftUp(std::size_t pos);
+  void SiftDown(std::size_t pos);
+
+  int grid_width_;
+  int grid_height_;
+  GridGeometry geometry_;  // splits cells without dividing on 2^n widths
+
+  std::vector<int> g_;
+  std::vector<int> rhs_;
+  std::vector<Key> key_;
+  std::vector<int> heap_pos_;  // index into heap_, or kNotQueued
+  std::vector<std::uint32_t> stamp_;
+  std::vector<std::uint8_t> blocked_;  // world as last seen by the tree
+  std::vector<std::uint8_t> goal_;     // goal cells as last seen
+  std::vector<int> heap_;
+  std::uint32_t generation_{0};
+
+  bool has_tree_{false};
+  Target target_{false, 0, OccupancyGrid::Layer::kFood};
+  int start_{0};
+  int last_start_{0};
+  int reached_goal_{-1};  // goal cell the last extracted path ended at
+  int key_modifier_{0};  // D* Lite's k_m: heuristic drift as start moves
+  std::uint64_t seen_version_{0};  // world.Version() blocked_ reflects
+
+  std::size_t expanded_{0};
+  std::size_t changed_{0};
+};
+
+#endif
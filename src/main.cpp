@@ -1,12 +1,15 @@
+#include <cstdlib>
 #include <iostream>
 #include "controller.h"
 #include "game.h"
 #include "renderer.h"
 #include "highscore.h"
+#include "profiler.h"
 
 int main() {
-  constexpr std::size_t kFramesPerSecond{60};
-  constexpr std::size_t kMsPerFrame{1000 / kFramesPerSecond};
+  // Render rate cap; the simulation runs at Game::kTicksPerSecond regardless
+  constexpr std::size_t kMaxFramesPerSecond{240};
+  constexpr std::size_t kMsPerFrame{1000 / kMaxFramesPerSecond};
   constexpr std::size_t kScreenWidth{640};
   constexpr std::size_t kScreenHeight{640};
   constexpr std::size_t kGridWidth{32};
@@ -42,6 +45,13 @@ int main() {
   std::cout << "\nGray blocks are obstacles - avoid them!\n";
   std::cout << "\nStarting game...\n\n";
 
+  // Set SNAKE_TRACE=<file> to record per-phase timings as a Chrome trace
+  const char *trace_file = std::getenv("SNAKE_TRACE");
+  if (trace_file != nullptr) {
+    Profiler::Instance().SetEnabled(true);
+    Profiler::Instance().SetThreadName("main");
+  }
+
   Renderer renderer(kScreenWidth, kScreenHeight, kGridWidth, kGridHeight);
   Controller controller;
   Game game(kGridWidth, kGridHeight, enable_ai);
@@ -49,6 +59,16 @@ int main() {
 
   game.Run(controller, renderer, kMsPerFrame);
 
+  if (trace_file != nullptr) {
+    Profiler::FrameStats stats = Profiler::Instance().GetFrameStats();
+    std::cout << "\nFrame time over " << stats.frames << " frames: p50 "
+              << stats.p50_ms << " ms, p95 " << stats.p95_ms << " ms, p99 "
+              << stats.p99_ms << " ms, max " << stats.max_ms << " ms\n";
+    if (Profiler::Instance().WriteChromeTrace(trace_file)) {
+      std::cout << "Trace written to " << trace_file << "\n";
+    }
+  }
+
   std::cout << "\nGame has terminated!\n";
   std::cout << "Your Score: " << game.GetScore() << "\n";
   std::cout << "Your Size: " << game.GetSize() << "\n";
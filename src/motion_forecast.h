@@ -0,0 +1,83 @@
+#ifndef MOTION_FORECAST_H
+#define MOTION_FORECAST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SDL.h"
+
+// What the AI snake can predict about the world over its next few moves,
+// measured in steps (cells the AI head advances). Snake bodies drain from
+// the tail at a known rate and moving obstacles follow fixed patterns, so a
+// cell that is occupied now may be free by the time the AI gets there.
+// Filled in by Game and read by SpaceTimePlanner.
+struct MotionForecast {
+  static constexpr std::uint16_t kNever = 0xFFFF;
+
+  MotionForecast(int grid_width, int grid_height)
+      : width(grid_width),
+        height(grid_height),
+        free_at(static_cast<std::size_t>(grid_width) * grid_height, 0) {}
+
+  // First step at which the AI head may enter the cell as far as snakes
+  // and fixed obstacles are concerned (0 = free now, kNever = not within
+  // the forecast)
+  std::uint16_t FreeAt(int x, int y) const {
+    return free_at[static_cast<std::size_t>(y) * width + x];
+  }
+  void BlockUntil(int x, int y, std::uint16_t step) {
+    std::uint16_t &cell = free_at[static_cast<std::size_t>(y) * width + x];
+    cell = std::max(cell, step);
+  }
+
+  // Can the AI head be in the cell at `step` without meeting anything? The
+  // head is taken to occupy it for a full step either side, which absorbs
+  // the sub-cell position the head starts from.
+  bool IsFree(int x, int y, int step) const {
+    if (FreeAt(x, y) > step) return false;
+    if (moving_count == 0) return true;
+    int first = UpdatesBy((step - 1) * ticks_per_step);
+    int last = std::min(UpdatesBy((step + 1) * ticks_per_step + 1), updates);
+    for (int u = first; u <= last; ++u) {
+      const SDL_Point *row =
+          &moving_cells[static_cast<std::size_t>(u) * moving_count];
+      for (int m = 0; m < moving_count; ++m) {
+        if (row[m].x == x && row[m].y == y) return false;
+      }
+    }
+    return true;
+  }
+
+  // Obstacle updates that will have happened `ticks` from now
+  int UpdatesBy(int ticks) const {
+    if (ticks < ticks_to_update) return 0;
+    return 1 + (ticks - ticks_to_update) / update_interval;
+  }
+
+  int width;
+  int height;
+
+  // Game ticks per AI step at its current speed
+  int ticks_per_step{10};
+  // Body segments trailing the AI head, counting growth still to come; a
+  // cell the head is in at step s is free again at step s + ai_length + 1
+  int ai_length{0};
+
+  std::vector<std::uint16_t> free_at;
+
+  // Food cells the AI is heading for: the kMaxGoals nearest by distance
+  // on the open board, nearest first
+  static constexpr std::size_t kMaxGoals = 8;
+  std::vector<SDL_Point> goals;
+
+  // Moving obstacle cells after 0, 1, ..., `updates` further obstacle
+  // updates, `moving_count` per row
+  int moving_count{0};
+  int updates{0};
+  int ticks_to_update{0};
+  int update_interval{1};
+  std::vector<SDL_Point> moving_cells;
+};
+
+#endif
@@ -1,195 +1,89 @@
 #include "obstacle.h"
-#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// A linear obstacle's offset from its home cell after each update of its
+// ten-update cycle: four steps out, five back, one out again
+constexpr int kLinearPeriod = 10;
+constexpr int kLinearTrack[kLinearPeriod] = {0, 1, 2, 3, 4, 3, 2, 1, 0, -1};
+
+// A circular obstacle's offset from its home cell after each update of
+// its orbit: (int)(3 cos a), (int)(3 sin a) for a = 2 pi i / 63, worked out
+// ahead so that obstacles land on the same cells whatever the compiler or
+// maths library
+constexpr int kOrbitPeriod = 63;
+constexpr SDL_Point kOrbitTrack[kOrbitPeriod] = {
+    {3, 0}, {2, 0}, {2, 0}, {2, 0}, {2, 1}, {2, 1}, {2, 1}, {2, 1}, {2, 2},
+    {1, 2}, {1, 2}, {1, 2}, {1, 2}, {0, 2}, {0, 2}, {0, 2}, {0, 2}, {0, 2},
+    {0, 2}, {0, 2}, {-1, 2}, {-1, 2}, {-1, 2}, {-1, 2}, {-2, 2}, {-2, 1},
+    {-2, 1}, {-2, 1}, {-2, 1}, {-2, 0}, {-2, 0}, {-2, 0}, {-2, 0}, {-2, 0},
+    {-2, 0}, {-2, -1}, {-2, -1}, {-2, -1}, {-2, -1}, {-2, -2}, {-1, -2},
+    {-1, -2}, {-1, -2}, {-1, -2}, {0, -2}, {0, -2}, {0, -2}, {0, -2}, {0, -2},
+    {0, -2}, {0, -2}, {1, -2}, {1, -2}, {1, -2}, {1, -2}, {2, -2}, {2, -1},
+    {2, -1}, {2, -1}, {2, -1}, {2, 0}, {2, 0}, {2, 0},
+};
+
+int Wrap(int value, int size) { return ((value % size) + size) % size; }
+
+}  // namespace
 
-// Initialize static member
-int Obstacle::next_id_ = 0;
-
-// Base Obstacle class implementation
-
-Obstacle::Obstacle(int x, int y, int grid_width, int grid_height)
-    : position_{x, y},
-      grid_width_(grid_width),
+ObstacleManager::ObstacleManager(int grid_width, int grid_height,
+                                 std::size_t num_fixed, std::size_t num_moving,
+                                 OccupancyGrid& grid, std::uint32_t seed)
+    : grid_width_(grid_width),
       grid_height_(grid_height),
-      obstacle_id_(new int(next_id_++)) {}
-
-Obstacle::~Obstacle() {
-  delete obstacle_id_;
-  obstacle_id_ = nullptr;
-}
-
-// Rule of 5: Copy constructor
-Obstacle::Obstacle(const Obstacle& other)
-    : position_(other.position_),
-      grid_width_(other.grid_width_),
-      grid_height_(other.grid_height_),
-      obstacle_id_(new int(*other.obstacle_id_)) {}
-
-// Rule of 5: Copy assignment operator
-Obstacle& Obstacle::operator=(const Obstacle& other) {
-  if (this != &other) {
-    position_ = other.position_;
-    grid_width_ = other.grid_width_;
-    grid_height_ = other.grid_height_;
-
-    // Deep copy the dynamically allocated resource
-    delete obstacle_id_;
-    obstacle_id_ = new int(*other.obstacle_id_);
-  }
-  return *this;
-}
-
-// Rule of 5: Move constructor
-Obstacle::Obstacle(Obstacle&& other) noexcept
-    : position_(other.position_),
-      grid_width_(other.grid_width_),
-      grid_height_(other.grid_height_),
-      obstacle_id_(other.obstacle_id_) {
-  // Transfer ownership, leave other in valid state
-  other.obstacle_id_ = nullptr;
-  other.position_ = {0, 0};
-}
-
-// Rule of 5: Move assignment operator
-Obstacle& Obstacle::operator=(Obstacle&& other) noexcept {
-  if (this != &other) {
-    // Clean up existing resource
-    delete obstacle_id_;
-
-    // Transfer ownership
-    position_ = other.position_;
-    grid_width_ = other.grid_width_;
-    grid_height_ = other.grid_height_;
-    obstacle_id_ = other.obstacle_id_;
-
-    // Leave other in valid state
-    other.obstacle_id_ = nullptr;
-    other.position_ = {0, 0};
-  }
-  return *this;
-}
-
-bool Obstacle::IsAt(int x, int y) const {
-  for (const auto& cell : GetOccupiedCells()) {
-    if (cell.x == x && cell.y == y) {
-      return true;
-    }
-  }
-  return false;
+      grid_(&grid),
+      engine_(seed) {
+  GenerateObstacles(num_fixed, num_moving);
 }
 
-std::vector<SDL_Point> Obstacle::GetOccupiedCells() const {
-  return {position_};
+void ObstacleManager::Advance(Phase& phase) {
+  phase.step = (phase.step + 1) % kLinearPeriod;
+  phase.orbit = (phase.orbit + 1) % kOrbitPeriod;
 }
 
-// FixedObstacle implementation
-
-FixedObstacle::FixedObstacle(int x, int y, int grid_width, int grid_height)
-    : Obstacle(x, y, grid_width, grid_height) {}
-
-void FixedObstacle::Update() {
-  // Fixed obstacles don't move - intentionally empty
+ObstacleManager::Offsets ObstacleManager::OffsetsAt(const Phase& phase) {
+  return Offsets{kLinearTrack[phase.step], kOrbitTrack[phase.orbit]};
 }
 
-// MovingObstacle implementation
-
-MovingObstacle::MovingObstacle(int x, int y, int grid_width, int grid_height,
-                               Pattern pattern)
-    : Obstacle(x, y, grid_width, grid_height),
-      pattern_(pattern),
-      direction_(1),
-      steps_moved_(0),
-      max_steps_(5),
-      angle_(0.0f) {}
-
-void MovingObstacle::Update() {
-  switch (pattern_) {
-    case Pattern::Horizontal:
-      UpdateHorizontal();
+SDL_Point ObstacleManager::Place(std::size_t i, const Offsets& offsets) const {
+  const SDL_Point& home = homes_[i];
+  switch (patterns_[i]) {
+    case Pattern::Fixed:
       break;
+    case Pattern::Horizontal:
+      return SDL_Point{Wrap(home.x + offsets.linear, grid_width_), home.y};
     case Pattern::Vertical:
-      UpdateVertical();
-      break;
+      return SDL_Point{home.x, Wrap(home.y + offsets.linear, grid_height_)};
     case Pattern::Circular:
-      UpdateCircular();
-      break;
-  }
-}
-
-void MovingObstacle::UpdateHorizontal() {
-  steps_moved_++;
-  if (steps_moved_ >= max_steps_) {
-    direction_ *= -1;
-    steps_moved_ = 0;
-  }
-
-  position_.x += direction_;
-
-  // Wrap around grid boundaries
-  if (position_.x < 0) position_.x = grid_width_ - 1;
-  if (position_.x >= grid_width_) position_.x = 0;
-}
-
-void MovingObstacle::UpdateVertical() {
-  steps_moved_++;
-  if (steps_moved_ >= max_steps_) {
-    direction_ *= -1;
-    steps_moved_ = 0;
+      // Clamped to the board rather than wrapped
+      return SDL_Point{
+          std::max(0, std::min(grid_width_ - 1, home.x + offsets.orbit.x)),
+          std::max(0, std::min(grid_height_ - 1, home.y + offsets.orbit.y))};
   }
-
-  position_.y += direction_;
-
-  // Wrap around grid boundaries
-  if (position_.y < 0) position_.y = grid_height_ - 1;
-  if (position_.y >= grid_height_) position_.y = 0;
-}
-
-void MovingObstacle::UpdateCircular() {
-  // Store original position as center
-  static int center_x = position_.x;
-  static int center_y = position_.y;
-  const int radius = 3;
-
-  angle_ += 0.1f;
-  if (angle_ > 2 * M_PI) angle_ -= 2 * M_PI;
-
-  int new_x = center_x + static_cast<int>(radius * std::cos(angle_));
-  int new_y = center_y + static_cast<int>(radius * std::sin(angle_));
-
-  // Clamp to grid boundaries
-  position_.x = std::max(0, std::min(grid_width_ - 1, new_x));
-  position_.y = std::max(0, std::min(grid_height_ - 1, new_y));
-}
-
-// ObstacleManager implementation
-
-ObstacleManager::ObstacleManager(int grid_width, int grid_height,
-                                 std::size_t num_fixed, std::size_t num_moving)
-    : grid_width_(grid_width),
-      grid_height_(grid_height),
-      engine_(std::random_device{}()) {
-  GenerateObstacles(num_fixed, num_moving);
+  return home;
 }
 
 void ObstacleManager::Update() {
-  for (auto& obstacle : obstacles_) {
-    obstacle->Update();
+  Advance(phase_);
+  Offsets offsets = OffsetsAt(phase_);
+  for (std::size_t i = num_fixed_; i < positions_.size(); ++i) {
+    SDL_Point next = Place(i, offsets);
+    SDL_Point& cell = positions_[i];
+    if (next.x == cell.x && next.y == cell.y) continue;
+    grid_->Remove(cell.x, cell.y, OccupancyGrid::Layer::kObstacle);
+    cell = next;
+    grid_->Add(cell.x, cell.y, OccupancyGrid::Layer::kObstacle);
   }
 }
 
 bool ObstacleManager::IsObstacleAt(int x, int y) const {
-  for (const auto& obstacle : obstacles_) {
-    if (obstacle->IsAt(x, y)) {
-      return true;
-    }
-  }
-  return false;
+  return grid_->Has(x, y, OccupancyGrid::Layer::kObstacle);
 }
 
-const std::vector<std::unique_ptr<Obstacle>>& ObstacleManager::GetObstacles() const {
-  return obstacles_;
-}
-
-bool ObstacleManager::CheckCollision(const std::vector<SDL_Point>& snake_body,
+bool ObstacleManager::CheckCollision(const SnakeBody& snake_body,
                                      int head_x, int head_y) const {
   // Check head collision
   if (IsObstacleAt(head_x, head_y)) {
@@ -198,12 +92,58 @@ bool ObstacleManager::CheckCollision(const std::vector<SDL_Point>& snake_body,
   return false;
 }
 
+void ObstacleManager::Forecast(int updates, int ticks_to_update, int interval,
+                               MotionForecast& forecast) const {
+  forecast.moving_count = static_cast<int>(positions_.size() - num_fixed_);
+  forecast.updates = updates;
+  forecast.ticks_to_update = ticks_to_update;
+  forecast.update_interval = interval;
+
+  for (std::size_t i = 0; i < num_fixed_; ++i) {
+    forecast.BlockUntil(positions_[i].x, positions_[i].y,
+                        MotionForecast::kNever);
+  }
+  if (forecast.moving_count == 0) {
+    forecast.moving_cells.clear();
+    return;
+  }
+
+  // Row u holds every moving obstacle's cell after u more updates, all
+  // placed from the same run-ahead phase
+  std::size_t rows = static_cast<std::size_t>(updates) + 1;
+  forecast.moving_cells.resize(rows * forecast.moving_count);
+  std::copy(positions_.begin() + num_fixed_, positions_.end(),
+            forecast.moving_cells.begin());
+  Phase phase = phase_;
+  for (std::size_t u = 1; u < rows; ++u) {
+    Advance(phase);
+    Offsets offsets = OffsetsAt(phase);
+    SDL_Point *row = &forecast.moving_cells[u * forecast.moving_count];
+    for (std::size_t i = num_fixed_; i < positions_.size(); ++i) {
+      *row++ = Place(i, offsets);
+    }
+  }
+}
+
 void ObstacleManager::GenerateObstacles(std::size_t num_fixed,
                                         std::size_t num_moving) {
   std::uniform_int_distribution<int> dist_x(0, grid_width_ - 1);
   std::uniform_int_distribution<int> dist_y(0, grid_height_ - 1);
   std::uniform_int_distribution<int> dist_pattern(0, 2);
 
+  // Never ask for more obstacles than there are safe cells to put them in
+  std::size_t reserved =
+      static_cast<std::size_t>(std::min(grid_width_, 2 * kSpawnMargin + 1)) *
+      std::min(grid_height_, 2 * kSpawnMargin + 1);
+  std::size_t capacity =
+      static_cast<std::size_t>(grid_width_) * grid_height_ - reserved;
+  num_fixed = std::min(num_fixed, capacity);
+  num_moving = std::min(num_moving, capacity - num_fixed);
+
+  positions_.reserve(num_fixed + num_moving);
+  homes_.reserve(num_fixed + num_moving);
+  patterns_.reserve(num_fixed + num_moving);
+
   // Generate fixed obstacles
   for (std::size_t i = 0; i < num_fixed; ++i) {
     int x, y;
@@ -212,9 +152,9 @@ void ObstacleManager::GenerateObstacles(std::size_t num_fixed,
       y = dist_y(engine_);
     } while (!IsSafeSpawnLocation(x, y));
 
-    obstacles_.push_back(
-        std::make_unique<FixedObstacle>(x, y, grid_width_, grid_height_));
+    Spawn(Pattern::Fixed, x, y);
   }
+  num_fixed_ = num_fixed;
 
   // Generate moving obstacles
   for (std::size_t i = 0; i < num_moving; ++i) {
@@ -224,28 +164,26 @@ void ObstacleManager::GenerateObstacles(std::size_t num_fixed,
       y = dist_y(engine_);
     } while (!IsSafeSpawnLocation(x, y));
 
-    auto pattern = static_cast<MovingObstacle::Pattern>(dist_pattern(engine_));
-    obstacles_.push_back(
-        std::make_unique<MovingObstacle>(x, y, grid_width_, grid_height_, pattern));
+    Spawn(static_cast<Pattern>(1 + dist_pattern(engine_)), x, y);
   }
 }
 
+void ObstacleManager::Spawn(Pattern pattern, int x, int y) {
+  positions_.push_back(SDL_Point{x, y});
+  homes_.push_back(SDL_Point{x, y});
+  patterns_.push_back(pattern);
+  grid_->Add(x, y, OccupancyGrid::Layer::kObstacle);
+}
+
 bool ObstacleManager::IsSafeSpawnLocation(int x, int y) const {
   // Avoid center area where snake spawns (with margin)
   int center_x = grid_width_ / 2;
   int center_y = grid_height_ / 2;
-  int margin = 4;
-
-  if (std::abs(x - center_x) <= margin && std::abs(y - center_y) <= margin) {
+  if (std::abs(x - center_x) <= kSpawnMargin &&
+      std::abs(y - center_y) <= kSpawnMargin) {
     return false;
   }
 
   // Avoid existing obstacle positions
-  for (const auto& obstacle : obstacles_) {
-    if (obstacle->IsAt(x, y)) {
-      return false;
-    }
-  }
-
-  return true;
+  return !IsObstacleAt(x, y);
 }
@@ -2,120 +2,92 @@
 #define OBSTACLE_H
 
 #include "SDL.h"
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <memory>
 #include <random>
-
-// Abstract base class for obstacles
-// Satisfies Memory rubric: RAII, destructors, smart pointers
-class Obstacle {
- public:
-  // Constructor with member initialization list
-  Obstacle(int x, int y, int grid_width, int grid_height);
-
-  // Virtual destructor for proper polymorphic destruction
-  virtual ~Obstacle();
-
-  // Rule of 5: Explicitly define copy/move operations
-  // Copy constructor
-  Obstacle(const Obstacle& other);
-  // Copy assignment operator
-  Obstacle& operator=(const Obstacle& other);
-  // Move constructor
-  Obstacle(Obstacle&& other) noexcept;
-  // Move assignment operator
-  Obstacle& operator=(Obstacle&& other) noexcept;
-
-  // Pure virtual method for updating obstacle (movement logic)
-  virtual void Update() = 0;
-
-  // Check if obstacle occupies given position
-  bool IsAt(int x, int y) const;
-
-  // Getters
-  int GetX() const { return position_.x; }
-  int GetY() const { return position_.y; }
-  SDL_Point GetPosition() const { return position_; }
-
-  // Get all positions occupied by this obstacle (for larger obstacles)
-  virtual std::vector<SDL_Point> GetOccupiedCells() const;
-
- protected:
-  SDL_Point position_;
-  int grid_width_;
-  int grid_height_;
-
-  // RAII: Dynamically allocated resource for demonstrating Rule of 5
-  int* obstacle_id_;
-
-  // Static counter for unique IDs
-  static int next_id_;
-};
-
-// Fixed obstacle - stationary hazard
-class FixedObstacle : public Obstacle {
- public:
-  FixedObstacle(int x, int y, int grid_width, int grid_height);
-  ~FixedObstacle() override = default;
-
-  // Fixed obstacles don't move
-  void Update() override;
-};
-
-// Moving obstacle - hazard that moves in patterns
-class MovingObstacle : public Obstacle {
- public:
-  enum class Pattern { Horizontal, Vertical, Circular };
-
-  MovingObstacle(int x, int y, int grid_width, int grid_height, Pattern pattern);
-  ~MovingObstacle() override = default;
-
-  void Update() override;
-
- private:
-  Pattern pattern_;
-  int direction_;        // 1 or -1 for linear patterns
-  int steps_moved_;      // Counter for movement
-  int max_steps_;        // Maximum steps before reversing
-  float angle_;          // For circular pattern
-
-  void UpdateHorizontal();
-  void UpdateVertical();
-  void UpdateCircular();
-};
-
-// Obstacle manager using smart pointers
-// Satisfies Memory rubric: smart pointers, RAII, pass-by-reference
+#include "motion_forecast.h"
+#include "occupancy_grid.h"
+#include "snake_body.h"
+
+// All the obstacles in a game, stored as parallel arrays indexed by
+// obstacle: where each one is, where it started and how it moves. Fixed
+// obstacles come first, so an update walks just the moving ones' contiguous
+// entries, and nothing is allocated after construction.
+// Obstacle cells are mirrored into the shared occupancy grid, which answers
+// all position queries in O(1).
 class ObstacleManager {
  public:
-  ObstacleManager(int grid_width, int grid_height, std::size_t num_fixed,
-                  std::size_t num_moving);
+  // How an obstacle moves on each update. Fixed ones never do; horizontal
+  // and vertical ones slide back and forth across their home cell, wrapping
+  // at the edges; circular ones orbit their home cell.
+  enum class Pattern : std::uint8_t { Fixed, Horizontal, Vertical, Circular };
 
-  // Destructor follows RAII - unique_ptr handles cleanup automatically
-  ~ObstacleManager() = default;
+  ObstacleManager(int grid_width, int grid_height, std::size_t num_fixed,
+                  std::size_t num_moving, OccupancyGrid& grid,
+                  std::uint32_t seed);
 
-  // Update all obstacles (movement)
+  // Move every moving obstacle one step along its pattern
   void Update();
 
   // Check if any obstacle is at position (pass by value for small types)
   bool IsObstacleAt(int x, int y) const;
 
-  // Get all obstacles for rendering (pass by const reference)
-  const std::vector<std::unique_ptr<Obstacle>>& GetObstacles() const;
+  // Every obstacle's cell and pattern, index for index, for rendering
+  std::size_t Size() const { return positions_.size(); }
+  const std::vector<SDL_Point>& Positions() const { return positions_; }
+  const std::vector<Pattern>& Patterns() const { return patterns_; }
 
   // Check collision with snake body positions (pass by const reference)
-  bool CheckCollision(const std::vector<SDL_Point>& snake_body, int head_x,
+  bool CheckCollision(const SnakeBody& snake_body, int head_x,
                       int head_y) const;
 
+  // Record fixed obstacles as never clearing and moving obstacles' cells
+  // for the next `updates` calls to Update(), the first of which happens
+  // `ticks_to_update` game ticks from now and then every `interval` ticks
+  void Forecast(int updates, int ticks_to_update, int interval,
+                MotionForecast& forecast) const;
+
  private:
-  std::vector<std::unique_ptr<Obstacle>> obstacles_;
+  // Every obstacle spawns with the manager and moves on every update, so
+  // one phase places them all: how far the linear patterns are through
+  // their back-and-forth and the circular ones round their orbit
+  struct Phase {
+    int step;
+    int orbit;
+  };
+
+  // Where a phase puts obstacles relative to their home cells
+  struct Offsets {
+    int linear;
+    SDL_Point orbit;
+  };
+
+  static void Advance(Phase& phase);
+  static Offsets OffsetsAt(const Phase& phase);
+  // Obstacle i's cell at the given offsets
+  SDL_Point Place(std::size_t i, const Offsets& offsets) const;
+
+  std::vector<SDL_Point> positions_;
+  std::vector<SDL_Point> homes_;
+  std::vector<Pattern> patterns_;
+  // Obstacles [0, num_fixed_) are fixed, the rest move
+  std::size_t num_fixed_{0};
+  Phase phase_{0, 0};
+
   int grid_width_;
   int grid_height_;
+  OccupancyGrid *grid_;
   std::mt19937 engine_;
 
+  // Half-size of the square kept clear around the player's spawn point
+  static constexpr int kSpawnMargin = 4;
+
   // Helper to generate obstacles avoiding center where snake spawns
   void GenerateObstacles(std::size_t num_fixed, std::size_t num_moving);
   bool IsSafeSpawnLocation(int x, int y) const;
+  // Add an obstacle and mark its cell in the grid
+  void Spawn(Pattern pattern, int x, int y);
 };
 
 #endif
@@ -0,0 +1,18 @@
+#include "occupancy_grid.h"
+
+OccupancyGrid::OccupancyGrid(int grid_width, int grid_height)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      cells_(static_cast<std::size_t>(grid_width) * grid_height, Cell{}) {}
+
+void OccupancyGrid::CatchUp(const OccupancyGrid& source) {
+  bool journaled = source.ForEachChangeSince(version_, [&](int x, int y) {
+    CellAt(x, y) = source.CellAt(x, y);
+  });
+  if (!journaled) {
+    *this = source;
+    return;
+  }
+  journal_ = source.journal_;
+  version_ = source.version_;
+}
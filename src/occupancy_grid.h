@@ -0,0 +1,103 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Dense per-cell record of what occupies the world grid, owned by Game and
+// updated incrementally as snakes move, food is placed or eaten and
+// obstacles move. Each layer keeps a count rather than a flag so overlapping
+// entities (a snake crossing itself, an obstacle sliding onto food) are
+// tracked correctly. All queries are O(1).
+class OccupancyGrid {
+ public:
+  enum class Layer : std::uint8_t { kPlayer, kAI, kObstacle, kFood };
+  static constexpr std::size_t kNumLayers = 4;
+
+  OccupancyGrid(int grid_width, int grid_height);
+
+  void Add(int x, int y, Layer layer) {
+    CellAt(x, y)[Slot(layer)]++;
+    RecordChange(x, y);
+  }
+  void Remove(int x, int y, Layer layer) {
+    CellAt(x, y)[Slot(layer)]--;
+    RecordChange(x, y);
+  }
+
+  // Is the cell occupied by the given layer?
+  bool Has(int x, int y, Layer layer) const {
+    return CellAt(x, y)[Slot(layer)] != 0;
+  }
+
+  // Nothing at all in the cell
+  bool IsEmpty(int x, int y) const {
+    const Cell &cell = CellAt(x, y);
+    return (cell[0] | cell[1] | cell[2] | cell[3]) == 0;
+  }
+
+  // Occupied by a snake or an obstacle (food does not block movement)
+  bool IsBlocked(int x, int y) const {
+    const Cell &cell = CellAt(x, y);
+    return (cell[Slot(Layer::kPlayer)] | cell[Slot(Layer::kAI)] |
+            cell[Slot(Layer::kObstacle)]) != 0;
+  }
+
+  int Width() const { return grid_width_; }
+  int Height() const { return grid_height_; }
+
+  // Bumped by every change, so planners can tell whether the walkable area
+  // or the food may have changed since they last looked
+  std::uint64_t Version() const { return version_; }
+
+  // The most recent kJournalSize changes are remembered, so a
+  // consumer that last looked at `since` can visit just the cells touched
+  // since then. Returns false if that is further back than the journal
+  // reaches; the consumer must then rescan the whole grid.
+  static constexpr std::uint64_t kJournalSize = 256;
+  template <typename Visit>
+  bool ForEachChangeSince(std::uint64_t since, Visit&& visit) const {
+    if (since > version_ || version_ - since > kJournalSize) return false;
+    for (std::uint64_t v = since; v < version_; ++v) {
+      std::uint32_t cell = journal_[v % kJournalSize];
+      visit(static_cast<int>(cell % grid_width_),
+            static_cast<int>(cell / grid_width_));
+    }
+    return true;
+  }
+
+  // Bring a copy of `source` taken earlier up to date by replaying
+  // source's journal, so only the cells changed since are copied; a copy
+  // further behind than the journal reaches is replaced outright. The copy
+  // takes on source's version and journal, so whatever follows it through
+  // the journal carries on as if it were following source.
+  void CatchUp(const OccupancyGrid& source);
+
+ private:
+  using Cell = std::array<std::uint8_t, kNumLayers>;
+
+  static constexpr std::size_t Slot(Layer layer) {
+    return static_cast<std::size_t>(layer);
+  }
+  Cell &CellAt(int x, int y) {
+    return cells_[static_cast<std::size_t>(y) * grid_width_ + x];
+  }
+  const Cell &CellAt(int x, int y) const {
+    return cells_[static_cast<std::size_t>(y) * grid_width_ + x];
+  }
+  void RecordChange(int x, int y) {
+    journal_[version_ % kJournalSize] =
+        static_cast<std::uint32_t>(y) * grid_width_ + x;
+    version_++;
+  }
+
+  int grid_width_;
+  int grid_height_;
+  std::vector<Cell> cells_;
+  std::array<std::uint32_t, kJournalSize> journal_{};
+  std::uint64_t version_{0};
+};
+
+#endif
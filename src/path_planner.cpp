@@ -0,0 +1,519 @@
+#include "path_planner.h"
+#include <algorithm>
+
+PathPlanner::PathPlanner(int grid_width, int grid_height)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      geometry_(grid_width, grid_height),
+      blocked_(grid_width, grid_height) {
+  std::size_t cells = static_cast<std::size_t>(grid_width) * grid_height;
+  g_cost_.resize(cells);
+  f_cost_.resize(cells);
+  parent_.resize(cells);
+  heap_pos_.resize(cells);
+  stamp_.assign(cells, 0);
+  heap_.reserve(cells);
+  arrival_.resize(cells);
+  pending_.resize(cells);
+  explored_.resize(cells);
+  runs_[0].resize(cells);
+  runs_[1].resize(cells);
+  row_dirty_.assign(grid_height, 0);
+  dirty_rows_.reserve(grid_height);
+}
+
+bool PathPlanner::FindPath(const OccupancyGrid& world, SDL_Point start,
+                           SDL_Point goal, std::vector<SDL_Point>& path) {
+  PlanBudget unlimited;
+  return FindPath(world, start, goal, unlimited, path);
+}
+
+bool PathPlanner::FindPath(const OccupancyGrid& world, SDL_Point start,
+                           SDL_Point goal, PlanBudget& budget,
+                           std::vector<SDL_Point>& path) {
+  if (mode_ == Mode::kJumpPoint) {
+    return JumpPointSearch(world, start, goal, budget, path);
+  }
+  // One copy of the search per common board size, with the dimensions
+  // folded in
+  return WithGeometry(geometry_, [&](const auto& grid) {
+    return AStarSearch(grid, world, start, goal, budget, path);
+  });
+}
+
+void PathPlanner::NoteProgress(int cell, int& best) const {
+  int h = f_cost_[cell] - g_cost_[cell];
+  int best_h = f_cost_[best] - g_cost_[best];
+  if (h < best_h || (h == best_h && g_cost_[cell] > g_cost_[best])) {
+    best = cell;
+  }
+}
+
+template <typename Geometry>
+bool PathPlanner::AStarSearch(const Geometry& grid, const OccupancyGrid& world,
+                              SDL_Point start, SDL_Point goal,
+                              PlanBudget& budget,
+                              std::vector<SDL_Point>& path) {
+  path.clear();
+  expanded_ = 0;
+  NextGeneration();
+  heap_.clear();
+
+  int start_cell = grid.Cell(start.x, start.y);
+  int goal_cell = grid.Cell(goal.x, goal.y);
+
+  stamp_[start_cell] = generation_;
+  g_cost_[start_cell] = 0;
+  f_cost_[start_cell] = grid.Distance(start.x, start.y, goal.x, goal.y);
+  parent_[start_cell] = -1;
+  HeapPush(start_cell);
+  int best = start_cell;
+
+  while (!heap_.empty()) {
+    if (budget.Expired()) {
+      ReconstructPath(best, path);
+      return false;
+    }
+    int current = HeapPop();
+    heap_pos_[current] = kClosed;
+    expanded_++;
+
+    if (current == goal_cell) {
+      ReconstructPath(current, path);
+      return true;
+    }
+    NoteProgress(current, best);
+
+    int x = grid.X(current);
+    int y = grid.Y(current);
+
+    // Four cardinal directions with wrapping
+    const int neighbors[4] = {
+        grid.Cell(grid.Right(x), y), grid.Cell(grid.Left(x), y),
+        grid.Cell(x, grid.Down(y)), grid.Cell(x, grid.Up(y))};
+
+    int tentative_g = g_cost_[current] + 1;
+    for (int next : neighbors) {
+      if (Seen(next)) {
+        // Closed, or already open with an equal or better route
+        if (heap_pos_[next] == kClosed || tentative_g >= g_cost_[next]) {
+          continue;
+        }
+        f_cost_[next] -= g_cost_[next] - tentative_g;
+        g_cost_[next] = tentative_g;
+        parent_[next] = current;
+        SiftUp(heap_pos_[next]);
+        continue;
+      }
+
+      int nx = grid.X(next);
+      int ny = grid.Y(next);
+      if (world.IsBlocked(nx, ny)) continue;
+
+      stamp_[next] = generation_;
+      g_cost_[next] = tentative_g;
+      f_cost_[next] = tentative_g + grid.Distance(nx, ny, goal.x, goal.y);
+      parent_[next] = current;
+      HeapPush(next);
+    }
+  }
+
+  // No path found
+  return false;
+}
+
+bool PathPlanner::JumpPointSearch(const OccupancyGrid& world,
+                                  SDL_Point start, SDL_Point goal,
+                                  PlanBudget& budget,
+                                  std::vector<SDL_Point>& path) {
+  path.clear();
+  expanded_ = 0;
+  NextGeneration();
+  heap_.clear();
+  SyncJumpState(world);
+
+  int start_cell = start.y * grid_width_ + start.x;
+  int goal_cell = goal.y * grid_width_ + goal.x;
+
+  stamp_[start_cell] = generation_;
+  g_cost_[start_cell] = 0;
+  f_cost_[start_cell] = Heuristic(start.x, start.y, goal.x, goal.y);
+  parent_[start_cell] = -1;
+  pending_[start_cell] = kAllDirections;
+  explored_[start_cell] = 0;
+  HeapPush(start_cell);
+  int best = start_cell;
+
+  while (!heap_.empty()) {
+    if (budget.Expired()) {
+      ReconstructJumpPath(best, path);
+      return false;
+    }
+    int current = HeapPop();
+    heap_pos_[current] = kClosed;
+    expanded_++;
+
+    if (current == goal_cell) {
+      ReconstructJumpPath(current, path);
+      return true;
+    }
+    NoteProgress(current, best);
+
+    int x = geometry_.X(current);
+    int y = geometry_.Y(current);
+    std::uint8_t directions = pending_[current];
+    pending_[current] = 0;
+    explored_[current] |= directions;
+
+    for (int dir = 0; dir < 4; ++dir) {
+      if (!(directions & (1 << dir))) continue;
+      int steps = 0;
+      int jump = Jump(x, y, dir, goal, steps);
+      if (jump < 0) continue;
+      RelaxJump(jump, current, g_cost_[current] + steps, dir,
+                Successors(geometry_.X(jump), geometry_.Y(jump), dir),
+                goal);
+    }
+  }
+
+  // No path found
+  return false;
+}
+
+void PathPlanner::SyncJumpState(const OccupancyGrid& world) {
+  bool journaled =
+      runs_synced_ &&
+      world.ForEachChangeSince(runs_version_, [&](int, int y) {
+        for (int row : {y == 0 ? grid_height_ - 1 : y - 1, y,
+                        y + 1 == grid_height_ ? 0 : y + 1}) {
+          if (row_dirty_[row]) continue;
+          row_dirty_[row] = 1;
+          dirty_rows_.push_back(row);
+        }
+      });
+  blocked_.Sync(world);
+
+  if (!journaled) {
+    for (int y = 0; y < grid_height_; ++y) MeasureRuns(y);
+  } else {
+    for (int y : dirty_rows_) MeasureRuns(y);
+  }
+  for (int y : dirty_rows_) row_dirty_[y] = 0;
+  dirty_rows_.clear();
+  runs_synced_ = true;
+  runs_version_ = world.Version();
+}
+
+void PathPlanner::MeasureRuns(int y) {
+  const SDL_Point nowhere{-1, -1};
+  const std::uint64_t *row = blocked_.Row(y);
+  int *runs[2] = {&runs_[0][static_cast<std::size_t>(y) * grid_width_],
+                  &runs_[1][static_cast<std::size_t>(y) * grid_width_]};
+
+  for (int dx : {1, -1}) {
+    // Walk the row against the run twice round, carrying the nearest stop
+    // ahead: the first lap finds the stop a run wraps round to, the second
+    // records how far each cell is from its stop if that is a turn rather
+    // than a blocked cell. A run never stops on the cell it started from.
+    int *run = runs[dx > 0 ? 0 : 1];
+    int stop = -1;
+    bool turn = false;
+    int x = dx > 0 ? grid_width_ - 1 : 0;
+    std::uint64_t stops = StopBits(y, x >> 6, dx, nowhere);
+    for (int i = 0; i < 2 * grid_width_; ++i) {
+      if (i >= grid_width_) {
+        int distance = dx * (stop - x);
+        if (distance < 0) distance += grid_width_;
+        run[x] = turn && stop != x ? distance : 0;
+      }
+      if ((stops >> (x & 63)) & 1) {
+        stop = x;
+        turn = !((row[x >> 6] >> (x & 63)) & 1);
+      }
+      int next = x - dx;
+      if (next == grid_width_) next = 0;
+      if (next < 0) next = grid_width_ - 1;
+      if ((next >> 6) != (x >> 6)) stops = StopBits(y, next >> 6, dx, nowhere);
+      x = next;
+    }
+  }
+}
+
+int PathPlanner::Jump(int x, int y, int dir, SDL_Point goal,
+                      int& steps) const {
+  if (dir < 2) {
+    if (y == goal.y) {
+      return JumpHorizontal(x, y, dir == 0 ? 1 : -1, goal, steps);
+    }
+    int cell = y * grid_width_ + x;
+    steps = runs_[dir][cell];
+    if (steps == 0) return -1;
+    int stop = x + (dir == 0 ? steps : -steps);
+    if (stop >= grid_width_) stop -= grid_width_;
+    if (stop < 0) stop += grid_width_;
+    return y * grid_width_ + stop;
+  }
+
+  // Vertical runs may turn sideways anywhere, so any cell from which a
+  // sideways run finds something is a jump point. Only the goal's row
+  // needs scanning; elsewhere the run tables already know.
+  int dy = dir == 2 ? 1 : -1;
+  for (steps = 1; steps < grid_height_; ++steps) {
+    y += dy;
+    if (y == grid_height_) y = 0;
+    if (y < 0) y = grid_height_ - 1;
+    if (blocked_.Test(x, y)) return -1;
+
+    if (y != goal.y) {
+      int cell = y * grid_width_ + x;
+      if (runs_[0][cell] != 0 || runs_[1][cell] != 0) return cell;
+      continue;
+    }
+    int sideways;
+    if (x == goal.x || JumpHorizontal(x, y, 1, goal, sideways) >= 0 ||
+        JumpHorizontal(x, y, -1, goal, sideways) >= 0) {
+      return y * grid_width_ + x;
+    }
+  }
+  return -1;
+}
+
+int PathPlanner::JumpHorizontal(int x, int y, int dx, SDL_Point goal,
+                                int& steps) const {
+  // Scan a word of the row at a time for the nearest stop, wrapping round
+  // but never back onto the starting cell
+  const int last_bit = (grid_width_ - 1) & 63;
+  const int last_word = blocked_.WordsPerRow() - 1;
+  int remaining = grid_width_ - 1;
+  int travelled = 0;
+  int p = x + dx;
+  if (p == grid_width_) p = 0;
+  if (p < 0) p = grid_width_ - 1;
+
+  while (remaining > 0) {
+    int w = p >> 6;
+    int b = p & 63;
+    std::uint64_t stops = StopBits(y, w, dx, goal);
+    int span;
+    int hit = -1;
+    if (dx > 0) {
+      span = (w == last_word ? last_bit : 63) - b + 1;
+      std::uint64_t ahead = stops >> b;  // bit k is cell p + k
+      if (ahead != 0) hit = __builtin_ctzll(ahead);
+    } else {
+      span = b + 1;
+      std::uint64_t ahead = stops << (63 - b);  // bit 63 - k is cell p - k
+      if (ahead != 0) hit = __builtin_clzll(ahead);
+    }
+    span = std::min(span, remaining);
+    if (hit >= 0 && hit < span) {
+      int cell_x = p + dx * hit;
+      steps = travelled + hit + 1;
+      if (blocked_.Test(cell_x, y)) return -1;
+      return y * grid_width_ + cell_x;
+    }
+
+    travelled += span;
+    remaining -= span;
+    p += dx * span;
+    if (p >= grid_width_) p -= grid_width_;
+    if (p < 0) p += grid_width_;
+  }
+  return -1;
+}
+
+std::uint64_t PathPlanner::StopBits(int y, int w, int dx,
+                                    SDL_Point goal) const {
+  int up = y == 0 ? grid_height_ - 1 : y - 1;
+  int down = y + 1 == grid_height_ ? 0 : y + 1;
+  const std::uint64_t *row = blocked_.Row(y);
+  const std::uint64_t *above = blocked_.Row(up);
+  const std::uint64_t *below = blocked_.Row(down);
+
+  // A forced turn: free beside the run, blocked beside the cell before
+  std::uint64_t forced = ~row[w] & ((~above[w] & Behind(above, w, dx)) |
+                                    (~below[w] & Behind(below, w, dx)));
+  std::uint64_t stops = (row[w] | forced) & blocked_.ValidMask(w);
+  if (goal.y == y && (goal.x >> 6) == w) {
+    stops |= std::uint64_t{1} << (goal.x & 63);
+  }
+  return stops;
+}
+
+std::uint64_t PathPlanner::Behind(const std::uint64_t *row, int w,
+                                  int dx) const {
+  // Bit i says whether the cell one step back from x = 64 * w + i (against
+  // the direction of travel, wrapping) is blocked
+  const int last_bit = (grid_width_ - 1) & 63;
+  const int last_word = blocked_.WordsPerRow() - 1;
+  if (dx > 0) {
+    std::uint64_t carry = w > 0 ? row[w - 1] >> 63
+                                : (row[last_word] >> last_bit) & 1;
+    return (row[w] << 1) | carry;
+  }
+  std::uint64_t bits = row[w] >> 1;
+  if (w < last_word) bits |= row[w + 1] << 63;
+  if (w == last_word) bits |= (row[0] & 1) << last_bit;
+  return bits;
+}
+
+std::uint8_t PathPlanner::ForcedTurns(int x, int y, int dx) const {
+  // Turning vertically here is only needed if the cell behind the turn is
+  // blocked; otherwise the turn could have been taken one cell earlier
+  int behind = x - dx;
+  if (behind == grid_width_) behind = 0;
+  if (behind < 0) behind = grid_width_ - 1;
+  int down = y + 1 == grid_height_ ? 0 : y + 1;
+  int up = y == 0 ? grid_height_ - 1 : y - 1;
+  std::uint8_t turns = 0;
+  if (!blocked_.Test(x, down) && blocked_.Test(behind, down)) {
+    turns |= 1 << 2;
+  }
+  if (!blocked_.Test(x, up) && blocked_.Test(behind, up)) {
+    turns |= 1 << 3;
+  }
+  return turns;
+}
+
+std::uint8_t PathPlanner::Successors(int x, int y, int dir) const {
+  std::uint8_t successors = static_cast<std::uint8_t>(1 << dir);
+  if (dir >= 2) {
+    // Heading vertically: carry on, or turn either way
+    return successors | 0x3;
+  }
+  // Heading horizontally: carry on, or turn where forced to
+  return successors | ForcedTurns(x, y, dir == 0 ? 1 : -1);
+}
+
+void PathPlanner::RelaxJump(int cell, int from, int g, int dir,
+                            std::uint8_t successors, SDL_Point goal) {
+  if (!Seen(cell)) {
+    stamp_[cell] = generation_;
+    g_cost_[cell] = g;
+    f_cost_[cell] = g + Heuristic(geometry_.X(cell), geometry_.Y(cell),
+                                  goal.x, goal.y);
+    parent_[cell] = from;
+    arrival_[cell] = static_cast<std::uint8_t>(dir);
+    pending_[cell] = successors;
+    explored_[cell] = 0;
+    HeapPush(cell);
+    return;
+  }
+
+  if (g < g_cost_[cell]) {
+    f_cost_[cell] -= g_cost_[cell] - g;
+    g_cost_[cell] = g;
+    parent_[cell] = from;
+    arrival_[cell] = static_cast<std::uint8_t>(dir);
+    pending_[cell] = successors;
+    explored_[cell] = 0;
+  } else if (g == g_cost_[cell]) {
+    std::uint8_t fresh = successors & ~explored_[cell] & ~pending_[cell];
+    if (fresh == 0) return;
+    pending_[cell] |= fresh;
+  } else {
+    return;
+  }
+
+  if (heap_pos_[cell] == kClosed) {
+    HeapPush(cell);
+  } else {
+    SiftUp(heap_pos_[cell]);
+  }
+}
+
+void PathPlanner::ReconstructJumpPath(int goal_cell,
+                                      std::vector<SDL_Point>& path) const {
+  // Each jump is a straight run from its parent; lay the runs out cell by
+  // cell, walking back from the goal
+  for (int cell = goal_cell; parent_[cell] != -1; cell = parent_[cell]) {
+    int x = geometry_.X(cell);
+    int y = geometry_.Y(cell);
+    int steps = g_cost_[cell] - g_cost_[parent_[cell]];
+    int dir = arrival_[cell];
+    for (int i = 0; i < steps; ++i) {
+      path.push_back({x, y});
+      switch (dir) {
+        case 0: x = x == 0 ? grid_width_ - 1 : x - 1; break;
+        case 1: x = x + 1 == grid_width_ ? 0 : x + 1; break;
+        case 2: y = y == 0 ? grid_height_ - 1 : y - 1; break;
+        case 3: y = y + 1 == grid_height_ ? 0 : y + 1; break;
+      }
+    }
+  }
+  std::reverse(path.begin(), path.end());
+}
+
+int PathPlanner::Heuristic(int x, int y, int goal_x, int goal_y) const {
+  return geometry_.Distance(x, y, goal_x, goal_y);
+}
+
+void PathPlanner::NextGeneration() {
+  generation_++;
+  if (generation_ == 0) {
+    std::fill(stamp_.begin(), stamp_.end(), 0);
+    generation_ = 1;
+  }
+}
+
+bool PathPlanner::HeapLess(int a, int b) const {
+  if (f_cost_[a] != f_cost_[b]) return f_cost_[a] < f_cost_[b];
+  // Prefer deeper nodes on ties; they are closer to the goal
+  return g_cost_[a] > g_cost_[b];
+}
+
+void PathPlanner::HeapPush(int cell) {
+  heap_.push_back(cell);
+  heap_pos_[cell] = static_cast<int>(heap_.size() - 1);
+  SiftUp(heap_.size() - 1);
+}
+
+int PathPlanner::HeapPop() {
+  int top = heap_.front();
+  int last = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty()) {
+    heap_[0] = last;
+    heap_pos_[last] = 0;
+    SiftDown(0);
+  }
+  return top;
+}
+
+void PathPlanner::SiftUp(std::size_t pos) {
+  int cell = heap_[pos];
+  while (pos > 0) {
+    std::size_t parent = (pos - 1) / 2;
+    if (!HeapLess(cell, heap_[parent])) break;
+    heap_[pos] = heap_[parent];
+    heap_pos_[heap_[pos]] = static_cast<int>(pos);
+    pos = parent;
+  }
+  heap_[pos] = cell;
+  heap_pos_[cell] = static_cast<int>(pos);
+}
+
+void PathPlanner::SiftDown(std::size_t pos) {
+  int cell = heap_[pos];
+  std::size_t size = heap_.size();
+  while (true) {
+    std::size_t child = 2 * pos + 1;
+    if (child >= size) break;
+    if (child + 1 < size && HeapLess(heap_[child + 1], heap_[child])) child++;
+    if (!HeapLess(heap_[child], cell)) break;
+    heap_[pos] = heap_[child];
+    heap_pos_[heap_[pos]] = static_cast<int>(pos);
+    pos = child;
+  }
+  heap_[pos] = cell;
+  heap_pos_[cell] = static_cast<int>(pos);
+}
+
+void PathPlanner::ReconstructPath(int goal_cell,
+                                  std::vector<SDL_Point>& path) const {
+  // Walk parents back to the start, which is not part of the path
+  for (int cell = goal_cell; parent_[cell] != -1; cell = parent_[cell]) {
+    path.push_back({geometry_.X(cell), geometry_.Y(cell)});
+  }
+  std::reverse(path.begin(), path.end());
+}
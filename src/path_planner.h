@@ -0,0 +1,153 @@
+#ifndef PATH_PLANNER_H
+#define PATH_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SDL.h"
+#include "grid_bits.h"
+#include "grid_geometry.h"
+#include "occupancy_grid.h"
+#include "plan_budget.h"
+
+// A* over the wrapping 4-connected grid with all per-cell search state kept
+// in flat arrays indexed by cell (g-cost, f-cost, parent, generation stamp).
+// The arrays are sized once per grid and reused across searches: bumping the
+// generation invalidates the previous search without clearing anything, and
+// the open list is an intrusive binary heap over cell indices with
+// decrease-key, so a plan performs no allocations once warmed up.
+//
+// In jump point mode the search only stops at cells where a shortest path
+// may have to turn, and scans straight runs in between without queuing
+// them. On a 4-connected grid shortest paths can always be reordered to
+// turn from vertical to horizontal anywhere but from horizontal to
+// vertical only around an obstacle corner, so vertical runs look sideways
+// at every cell and horizontal runs stop only at such corners. As in JPS+,
+// where a horizontal run from each cell ends is worked out per row ahead of
+// time, so horizontal runs are a lookup and vertical runs test two entries
+// per cell rather than scanning two rows; only the goal's row is scanned.
+// Runs wrap like everything else. The path returned is the same length as
+// A*'s and still lists every cell. Like IncrementalPlanner, this mode expects
+// successive calls to see one world (or copies of it) as it evolves.
+class PathPlanner {
+ public:
+  enum class Mode { kAStar, kJumpPoint };
+
+  PathPlanner(int grid_width, int grid_height);
+
+  // Choose the search used by later FindPath calls
+  void SetMode(Mode mode) { mode_ = mode; }
+  Mode GetMode() const { return mode_; }
+
+  // Find a shortest path from start to goal avoiding blocked cells.
+  // On success the path (excluding start, ending at goal) is written into
+  // `path` and true is returned; `path` is left empty if goal is unreachable.
+  bool FindPath(const OccupancyGrid& world, SDL_Point start, SDL_Point goal,
+                std::vector<SDL_Point>& path);
+
+  // As above, giving up when `budget` expires. `path` then holds the way to
+  // the node searched so far that is nearest the goal, and false is
+  // returned.
+  bool FindPath(const OccupancyGrid& world, SDL_Point start, SDL_Point goal,
+                PlanBudget& budget, std::vector<SDL_Point>& path);
+
+  // Number of nodes expanded by the most recent search (jump points in
+  // jump point mode)
+  std::size_t Expanded() const { return expanded_; }
+
+  int Width() const { return grid_width_; }
+  int Height() const { return grid_height_; }
+
+ private:
+  static constexpr int kClosed = -1;
+
+  // Directions in neighbour order: +x, -x, +y, -y
+  static constexpr std::uint8_t kAllDirections = 0xF;
+
+  // Templated on the board's geometry (see WithGeometry)
+  template <typename Geometry>
+  bool AStarSearch(const Geometry& grid, const OccupancyGrid& world,
+                   SDL_Point start, SDL_Point goal, PlanBudget& budget,
+                   std::vector<SDL_Point>& path);
+  bool JumpPointSearch(const OccupancyGrid& world, SDL_Point start,
+                       SDL_Point goal, PlanBudget& budget,
+                       std::vector<SDL_Point>& path);
+  // Keep track of the expanded node nearest the goal (deepest on ties),
+  // the end of the partial path returned when a budget runs out
+  void NoteProgress(int cell, int& best) const;
+
+  // Bring blocked_ and the run tables up to date with the world
+  void SyncJumpState(const OccupancyGrid& world);
+  // Recompute row y of the run tables from blocked_
+  void MeasureRuns(int y);
+
+  // Scan from (x, y) in direction `dir` to the next jump point; returns its
+  // cell and distance in `steps`, or -1 if the run dead-ends
+  int Jump(int x, int y, int dir, SDL_Point goal, int& steps) const;
+  int JumpHorizontal(int x, int y, int dx, SDL_Point goal, int& steps) const;
+  // Cells of word w of row y where a run heading dx stops: blocked cells,
+  // forced turns and the goal
+  std::uint64_t StopBits(int y, int w, int dx, SDL_Point goal) const;
+  // Word w of a row shifted so each bit holds the cell behind it
+  std::uint64_t Behind(const std::uint64_t *row, int w, int dx) const;
+  // Vertical directions a run heading dx has to consider at (x, y)
+  std::uint8_t ForcedTurns(int x, int y, int dx) const;
+  // Directions worth searching from a jump point reached heading `dir`
+  std::uint8_t Successors(int x, int y, int dir) const;
+  // Record reaching `cell` from jump point `from` at cost g
+  void RelaxJump(int cell, int from, int g, int dir, std::uint8_t successors,
+                 SDL_Point goal);
+  void ReconstructJumpPath(int goal_cell, std::vector<SDL_Point>& path) const;
+
+  // Manhattan distance on the torus
+  int Heuristic(int x, int y, int goal_x, int goal_y) const;
+
+  // Start a new search generation, resetting stamps on wrap-around
+  void NextGeneration();
+  bool Seen(int cell) const { return stamp_[cell] == generation_; }
+
+  // Intrusive binary min-heap keyed on (f, -g)
+  bool HeapLess(int a, int b) const;
+  void HeapPush(int cell);
+  int HeapPop();
+  void SiftUp(std::size_t pos);
+  void SiftDown(std::size_t pos);
+
+  void ReconstructPath(int goal_cell, std::vector<SDL_Point>& path) const;
+
+  int grid_width_;
+  int grid_height_;
+  GridGeometry geometry_;
+
+  std::vector<int> g_cost_;
+  std::vector<int> f_cost_;
+  std::vector<int> parent_;
+  std::vector<int> heap_pos_;  // index into heap_, or kClosed once expanded
+  std::vector<std::uint32_t> stamp_;
+  std::vector<int> heap_;
+
+  // Jump point mode: blocked cells as bits, so runs scan a word at a time,
+  // kept current through the world's change journal; the direction each
+  // jump point was reached in; and the directions still to search from it
+  // or already searched. A jump point reached again at equal cost in
+  // another direction may add new directions and is reopened for them.
+  GridBits blocked_;
+  std::vector<std::uint8_t> arrival_;
+  std::vector<std::uint8_t> pending_;
+  std::vector<std::uint8_t> explored_;
+  // How far a horizontal run from each cell heading +x ([0]) or -x ([1])
+  // goes to reach a jump point, not counting the goal, or 0 if it
+  // dead-ends. A change to the world redoes its own row and the rows
+  // either side, whose forced turns depend on it.
+  std::vector<int> runs_[2];
+  std::vector<std::uint8_t> row_dirty_;
+  std::vector<int> dirty_rows_;
+  bool runs_synced_{false};
+  std::uint64_t runs_version_{0};
+
+  Mode mode_{Mode::kAStar};
+  std::uint32_t generation_{0};
+  std::size_t expanded_{0};
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PLAN_BUDGET_H
+#define PLAN_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// When a search has to stop: at a deadline, or as soon as the request it
+// serves has been superseded. Requests are numbered by a generation
+// counter that the requester bumps for each new one; a budget holds the
+// generation it was issued for and counts as cancelled once the counter
+// moves on. Searches poll Expired() once per expansion. The atomic load is
+// cheap, and the clock is read only every kClockInterval polls. Once
+// expired, a budget stays expired. A default-constructed budget never
+// expires.
+class PlanBudget {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  PlanBudget() = default;
+  PlanBudget(Clock::time_point deadline,
+             const std::atomic<std::uint64_t>* latest,
+             std::uint64_t generation)
+      : has_deadline_(true),
+        deadline_(deadline),
+        latest_(latest),
+        generation_(generation) {}
+
+  // Has a newer request replaced this one?
+  bool Cancelled() const {
+    return latest_ != nullptr &&
+           latest_->load(std::memory_order_relaxed) != generation_;
+  }
+
+  bool Expired() {
+    if (expired_) return true;
+    if (Cancelled()) {
+      expired_ = true;
+    } else if (has_deadline_ && ++polls_ == kClockInterval) {
+      polls_ = 0;
+      deadline_hit_ = Clock::now() >= deadline_;
+      expired_ = deadline_hit_;
+    }
+    return expired_;
+  }
+
+  // Did the deadline, rather than cancellation, stop a search?
+  bool DeadlineHit() const { return deadline_hit_; }
+
+ private:
+  static constexpr int kClockInterval = 64;
+
+  bool has_deadline_{false};
+  Clock::time_point deadline_{};
+  const std::atomic<std::uint64_t>* latest_{nullptr};
+  std::uint64_t generation_{0};
+  int polls_{0};
+  bool expired_{false};
+  bool deadline_hit_{false};
+};
+
+#endif
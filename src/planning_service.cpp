@@ -0,0 +1,119 @@
+#include "planning_service.h"
+#include <algorithm>
+#include <string>
+#include "profiler.h"
+
+namespace {
+
+// Heap order: true if a is served after b
+struct LaterRequest {
+  template <typename Request>
+  bool operator()(const Request& a, const Request& b) const {
+    if (a.urgency != b.urgency) return a.urgency > b.urgency;
+    return a.ticket > b.ticket;
+  }
+};
+
+}  // namespace
+
+PlanningService::PlanningService(unsigned threads) {
+  if (threads == 0) threads = DefaultThreads();
+  workers_.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i) {
+    workers_.emplace_back(&PlanningService::Worker, this, i);
+  }
+}
+
+PlanningService::~PlanningService() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) worker.join();
+}
+
+unsigned PlanningService::DefaultThreads() {
+  unsigned hardware = std::thread::hardware_concurrency();
+  return hardware > 1 ? hardware - 1 : 1;
+}
+
+void PlanningService::Submit(Client& client, int urgency) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.submitted++;
+    if (client.running_) {
+      // Queued again when the running plan finishes
+      if (client.again_) stats_.coalesced++;
+      client.urgency_ = client.again_ ? std::min(client.urgency_, urgency)
+                                      : urgency;
+      client.again_ = true;
+      return;
+    }
+    if (client.ticket_ != 0) {
+      stats_.coalesced++;
+      if (urgency >= client.urgency_) return;
+    }
+    Push(client, urgency);
+  }
+  work_cv_.notify_one();
+}
+
+void PlanningService::Withdraw(Client& client) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (client.ticket_ != 0) {
+    queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                [&](const Request& request) {
+                                  return request.client == &client;
+                                }),
+                 queue_.end());
+    std::make_heap(queue_.begin(), queue_.end(), LaterRequest{});
+    client.ticket_ = 0;
+  }
+  // Not requeued when a plan in progress finishes
+  client.again_ = false;
+  idle_cv_.wait(lock, [&] { return !client.running_; });
+}
+
+PlanningService::Stats PlanningService::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void PlanningService::Push(Client& client, int urgency) {
+  client.ticket_ = next_ticket_++;
+  client.urgency_ = urgency;
+  queue_.push_back(Request{urgency, client.ticket_, &client});
+  std::push_heap(queue_.begin(), queue_.end(), LaterRequest{});
+}
+
+void PlanningService::Worker(unsigned index) {
+  Profiler::Instance().SetThreadName("planner " + std::to_string(index));
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (stopping_) return;
+
+    std::pop_heap(queue_.begin(), queue_.end(), LaterRequest{});
+    Request request = queue_.back();
+    queue_.pop_back();
+    Client& client = *request.client;
+    if (client.ticket_ != request.ticket) continue;  // superseded
+
+    client.ticket_ = 0;
+    client.running_ = true;
+    lock.unlock();
+    client.Plan();
+    lock.lock();
+    client.running_ = false;
+    stats_.served++;
+
+    if (client.again_) {
+      client.again_ = false;
+      Push(client, client.urgency_);
+      work_cv_.notify_one();
+    }
+    idle_cv_.notify_all();
+  }
+}
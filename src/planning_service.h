@@ -0,0 +1,87 @@
+#ifndef PLANNING_SERVICE_H
+#define PLANNING_SERVICE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed pool of worker threads that plans for any number of clients, so
+// adding AI snakes adds work rather than threads. A client asks for a plan
+// with Submit() and does the planning itself in Plan(), on whichever
+// worker picks the request up. Requests are served most urgent first (the
+// lowest urgency value), in order of arrival among equals. A client holds
+// at most one place in the queue: asking again before its turn only
+// raises its priority, and asking while its plan is running queues it once
+// more for when that finishes. Plan() is expected to work on the client's
+// newest request, so the latest request per client wins and a client
+// never has two plans in progress at once.
+class PlanningService {
+ public:
+  class Client {
+   public:
+    virtual ~Client() = default;
+
+    // Serve the newest request; called on a worker thread
+    virtual void Plan() = 0;
+
+   private:
+    friend class PlanningService;
+    std::uint64_t ticket_{0};  // of the live queue entry; 0 if none
+    int urgency_{0};           // of that entry, or of the request to requeue
+    bool running_{false};
+    bool again_{false};  // asked for while running
+  };
+
+  struct Stats {
+    std::uint64_t submitted{0};
+    std::uint64_t coalesced{0};  // merged into a request already waiting
+    std::uint64_t served{0};
+  };
+
+  // threads = 0 leaves one hardware thread to the caller
+  explicit PlanningService(unsigned threads = 0);
+  ~PlanningService();
+
+  PlanningService(const PlanningService&) = delete;
+  PlanningService& operator=(const PlanningService&) = delete;
+
+  // Ask for client.Plan() to run. Never waits for planning.
+  void Submit(Client& client, int urgency);
+
+  // Drop the client's waiting request and wait out a plan in progress.
+  // Afterwards the service no longer refers to the client.
+  void Withdraw(Client& client);
+
+  unsigned Threads() const { return static_cast<unsigned>(workers_.size()); }
+  Stats GetStats() const;
+
+  // One worker per hardware thread, less one for the game loop
+  static unsigned DefaultThreads();
+
+ private:
+  struct Request {
+    int urgency;
+    std::uint64_t ticket;
+    Client* client;
+  };
+
+  void Worker(unsigned index);
+  // Queue an entry for the client, superseding any it has; mutex_ held
+  void Push(Client& client, int urgency);
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_cv_;  // a request arrived, or stopping
+  std::condition_variable idle_cv_;  // a plan finished
+  // Binary heap, most urgent on top. Entries whose ticket no longer
+  // matches their client's are stale and skipped when popped.
+  std::vector<Request> queue_;
+  std::uint64_t next_ticket_{1};
+  bool stopping_{false};
+  Stats stats_;
+
+  std::vector<std::thread> workers_;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+Profiler &Profiler::Instance() {
+  static Profiler instance;
+  return instance;
+}
+
+Profiler::Profiler() : epoch_ns_(NowNs()) {}
+
+std::uint64_t Profiler::NowNs() {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+Profiler::ThreadBuffer &Profiler::LocalBuffer() {
+  // Buffers live as long as the profiler so they outlive their threads
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (buffer == nullptr) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    buffers_.push_back(std::make_unique<ThreadBuffer>());
+    buffer = buffers_.back().get();
+    buffer->thread_id = static_cast<int>(buffers_.size());
+  }
+  return *buffer;
+}
+
+void Profiler::SetThreadName(const std::string &name) {
+  // Buffers are only created for threads that take part in a trace
+  if (!Enabled()) return;
+  ThreadBuffer &buffer = LocalBuffer();
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  buffer.name = name;
+}
+
+void Profiler::Record(const char *name, std::uint64_t start_ns,
+                      std::uint64_t end_ns) {
+  ThreadBuffer &buffer = LocalBuffer();
+  std::uint64_t index = buffer.written.load(std::memory_order_relaxed);
+  buffer.events[index % kEventsPerThread] = {name, start_ns,
+                                             end_ns - start_ns};
+  // Publish the slot before the count that makes it visible to readers
+  buffer.written.store(index + 1, std::memory_order_release);
+}
+
+std::size_t Profiler::BucketFor(std::uint64_t ns) {
+  if (ns < kSubBuckets) return static_cast<std::size_t>(ns);
+  int exponent = 63 - __builtin_clzll(ns);  // position of the top bit, >= 4
+  std::size_t sub = (ns >> (exponent - 4)) & (kSubBuckets - 1);
+  return (exponent - 3) * kSubBuckets + sub;
+}
+
+std::uint64_t Profiler::BucketUpperNs(std::size_t bucket) {
+  if (bucket < kSubBuckets) return bucket + 1;
+  int exponent = static_cast<int>(bucket / kSubBuckets) + 3;
+  std::uint64_t sub = bucket % kSubBuckets;
+  return (kSubBuckets + sub + 1) << (exponent - 4);
+}
+
+void Profiler::RecordFrame(std::uint64_t duration_ns) {
+  frame_buckets_[BucketFor(duration_ns)].fetch_add(1,
+                                                   std::memory_order_relaxed);
+
+  std::uint64_t max = max_frame_ns_.load(std::memory_order_relaxed);
+  while (duration_ns > max &&
+         !max_frame_ns_.compare_exchange_weak(max, duration_ns,
+                                              std::memory_order_relaxed)) {
+  }
+}
+
+Profiler::FrameStats Profiler::GetFrameStats() const {
+  FrameStats stats;
+  std::array<std::uint64_t, kNumBuckets> counts;
+  for (std::size_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = frame_buckets_[i].load(std::memory_order_relaxed);
+    stats.frames += counts[i];
+  }
+  stats.max_ms = max_frame_ns_.load(std::memory_order_relaxed) / 1e6;
+  if (stats.frames == 0) return stats;
+
+  // Report the upper edge of the bucket holding each percentile
+  auto percentile = [&](double p) {
+    std::uint64_t rank = static_cast<std::uint64_t>(p * (stats.frames - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kNumBuckets; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(BucketUpperNs(i) / 1e6, stats.max_ms);
+      }
+    }
+    return stats.max_ms;
+  };
+  stats.p50_ms = percentile(0.50);
+  stats.p95_ms = percentile(0.95);
+  stats.p99_ms = percentile(0.99);
+  return stats;
+}
+
+bool Profiler::WriteChromeTrace(const std::string &filename) const {
+  std::ofstream file(filename);
+  if (!file.is_open()) return false;
+
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  file << "{\"traceEvents\":[\n";
+  bool first = true;
+  auto separator = [&]() -> const char * {
+    const char *text = first ? "" : ",\n";
+    first = false;
+    return text;
+  };
+
+  for (const auto &buffer : buffers_) {
+    if (!buffer->name.empty()) {
+      file << separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+           << "\"tid\":" << buffer->thread_id << ",\"args\":{\"name\":\""
+           << buffer->name << "\"}}";
+    }
+
+    // Writers may still be running: only emit slots that cannot have been
+    // overwritten between the two reads of the write count
+    std::uint64_t end = buffer->written.load(std::memory_order_acquire);
+    std::uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+    std::vector<Event> events;
+    events.reserve(end - begin);
+    for (std::uint64_t i = begin; i < end; ++i) {
+      events.push_back(buffer->events[i % kEventsPerThread]);
+    }
+    std::uint64_t after = buffer->written.load(std::memory_order_acquire);
+    std::uint64_t safe_begin =
+        after > kEventsPerThread ? after - kEventsPerThread : 0;
+
+    for (std::uint64_t i = std::max(begin, safe_begin); i < end; ++i) {
+      const Event &event = events[i - begin];
+      file << separator() << "{\"name\":\"" << event.name
+           << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+           << ",\"ts\":" << (event.start_ns - epoch_ns_) / 1000.0
+           << ",\"dur\":" << event.duration_ns / 1000.0 << "}";
+    }
+  }
+  file << "\n]}\n";
+  return file.good();
+}
@@ -1,14 +1,33 @@
 #include "renderer.h"
+#include <cmath>
 #include <iostream>
 #include <string>
 
 Renderer::Renderer(const std::size_t screen_width,
                    const std::size_t screen_height,
-                   const std::size_t grid_width, const std::size_t grid_height)
+                   const std::size_t grid_width, const std::size_t grid_height,
+                   Target target)
     : screen_width(screen_width),
       screen_height(screen_height),
       grid_width(grid_width),
       grid_height(grid_height) {
+  if (target == Target::kOffscreen) {
+    // Software renderer drawing into a plain RGBA surface, no video subsystem
+    sdl_surface = SDL_CreateRGBSurface(0, screen_width, screen_height, 32, 0,
+                                       0, 0, 0);
+    if (nullptr == sdl_surface) {
+      std::cerr << "Offscreen surface could not be created.\n";
+      std::cerr << "SDL_Error: " << SDL_GetError() << "\n";
+      return;
+    }
+    sdl_renderer = SDL_CreateSoftwareRenderer(sdl_surface);
+    if (nullptr == sdl_renderer) {
+      std::cerr << "Renderer could not be created.\n";
+      std::cerr << "SDL_Error: " << SDL_GetError() << "\n";
+    }
+    return;
+  }
+
   // Initialize SDL
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
     std::cerr << "SDL could not initialize.\n";
@@ -26,7 +45,10 @@ Renderer::Renderer(const std::size_t screen_width,
   }
 
   // Create renderer
-  sdl_renderer = SDL_CreateRenderer(sdl_window, -1, SDL_RENDERER_ACCELERATED);
+  // Present in step with the display; the game loop renders as often as
+  // vsync allows and interpolates between fixed simulation ticks
+  sdl_renderer = SDL_CreateRenderer(
+      sdl_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
   if (nullptr == sdl_renderer) {
     std::cerr << "Renderer could not be created.\n";
     std::cerr << "SDL_Error: " << SDL_GetError() << "\n";
@@ -34,13 +56,21 @@ Renderer::Renderer(const std::size_t screen_width,
 }
 
 Renderer::~Renderer() {
+  if (sdl_surface) {
+    SDL_DestroyRenderer(sdl_renderer);
+    SDL_FreeSurface(sdl_surface);
+    return;
+  }
   SDL_DestroyWindow(sdl_window);
   SDL_Quit();
 }
 
-void Renderer::Render(Snake const &player_snake, AISnake const &ai_snake,
-                      const std::vector<std::unique_ptr<Food>>& foods,
-                      ObstacleManager const &obstacles, bool render_ai) {
+void Renderer::Render(Snake const &player_snake,
+                      std::vector<AISnake> const &ai_snakes,
+                      const std::vector<Food>& foods,
+                      const FoodRegistry& food_types,
+                      ObstacleManager const &obstacles, bool render_ai,
+                      float alpha) {
   // Clear screen
   SDL_SetRenderDrawColor(sdl_renderer, 0x1E, 0x1E, 0x1E, 0xFF);
   SDL_RenderClear(sdl_renderer);
@@ -49,21 +79,23 @@ void Renderer::Render(Snake const &player_snake, AISnake const &ai_snake,
   RenderObstacles(obstacles);
 
   // Render all food items
-  RenderFoods(foods);
+  RenderFoods(foods, food_types);
 
-  // Render AI snake only if enabled
+  // Render AI snakes only if enabled
   if (render_ai) {
-    RenderSnake(ai_snake, false);
+    for (AISnake const &ai_snake : ai_snakes) {
+      RenderSnake(ai_snake, false, alpha);
+    }
   }
 
   // Render player snake (on top)
-  RenderSnake(player_snake, true);
+  RenderSnake(player_snake, true, alpha);
 
   // Update Screen
   SDL_RenderPresent(sdl_renderer);
 }
 
-void Renderer::RenderSnake(Snake const &snake, bool is_player) {
+void Renderer::RenderSnake(Snake const &snake, bool is_player, float alpha) {
   SDL_Rect block;
   block.w = screen_width / grid_width;
   block.h = screen_height / grid_height;
@@ -83,9 +115,25 @@ void Renderer::RenderSnake(Snake const &snake, bool is_player) {
     SDL_RenderFillRect(sdl_renderer, &block);
   }
 
-  // Render snake's head
-  block.x = static_cast<int>(snake.head_x) * block.w;
-  block.y = static_cast<int>(snake.head_y) * block.h;
+  // Render snake's head at its continuous position, interpolated between the
+  // previous and the current simulation tick. A wrap-around jump or a dead
+  // snake snaps to the current position.
+  SDL_FRect head;
+  head.w = static_cast<float>(block.w);
+  head.h = static_cast<float>(block.h);
+  float x = snake.HeadPositionX();
+  float y = snake.HeadPositionY();
+  float prev_x = snake.PrevHeadPositionX();
+  float prev_y = snake.PrevHeadPositionY();
+  head.x = x;
+  head.y = y;
+  if (snake.alive && std::abs(x - prev_x) <= 1.0f &&
+      std::abs(y - prev_y) <= 1.0f) {
+    head.x = prev_x + (x - prev_x) * alpha;
+    head.y = prev_y + (y - prev_y) * alpha;
+  }
+  head.x *= block.w;
+  head.y *= block.h;
 
   if (snake.alive) {
     if (is_player) {
@@ -99,21 +147,22 @@ void Renderer::RenderSnake(Snake const &snake, bool is_player) {
     // Dead head: red
     SDL_SetRenderDrawColor(sdl_renderer, 0xFF, 0x00, 0x00, 0xFF);
   }
-  SDL_RenderFillRect(sdl_renderer, &block);
+  SDL_RenderFillRectF(sdl_renderer, &head);
 }
 
-void Renderer::RenderFoods(const std::vector<std::unique_ptr<Food>>& foods) {
+void Renderer::RenderFoods(const std::vector<Food>& foods,
+                           const FoodRegistry& food_types) {
   SDL_Rect block;
   block.w = screen_width / grid_width;
   block.h = screen_height / grid_height;
 
-  for (const auto& food : foods) {
+  for (const Food& food : foods) {
     // Get food color based on type
-    Color color = food->GetColor();
+    Color color = food_types.Traits(food.GetType()).color;
     SDL_SetRenderDrawColor(sdl_renderer, color.r, color.g, color.b, color.a);
 
-    block.x = food->GetX() * block.w;
-    block.y = food->GetY() * block.h;
+    block.x = food.GetX() * block.w;
+    block.y = food.GetY() * block.h;
     SDL_RenderFillRect(sdl_renderer, &block);
   }
 }
@@ -123,19 +172,19 @@ void Renderer::RenderObstacles(ObstacleManager const &obstacles) {
   block.w = screen_width / grid_width;
   block.h = screen_height / grid_height;
 
-  for (const auto &obstacle : obstacles.GetObstacles()) {
+  const std::vector<SDL_Point> &cells = obstacles.Positions();
+  const std::vector<ObstacleManager::Pattern> &patterns = obstacles.Patterns();
+  for (std::size_t i = 0; i < obstacles.Size(); ++i) {
     // Fixed obstacles: dark gray, Moving obstacles: lighter gray
-    if (dynamic_cast<const FixedObstacle*>(obstacle.get())) {
+    if (patterns[i] == ObstacleManager::Pattern::Fixed) {
       SDL_SetRenderDrawColor(sdl_renderer, 0x44, 0x44, 0x44, 0xFF);
     } else {
       SDL_SetRenderDrawColor(sdl_renderer, 0x66, 0x66, 0x66, 0xFF);
     }
 
-    for (const auto &cell : obstacle->GetOccupiedCells()) {
-      block.x = cell.x * block.w;
-      block.y = cell.y * block.h;
-      SDL_RenderFillRect(sdl_renderer, &block);
-    }
+    block.x = cells[i].x * block.w;
+    block.y = cells[i].y * block.h;
+    SDL_RenderFillRect(sdl_renderer, &block);
   }
 }
 
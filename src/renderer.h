@@ -11,21 +11,32 @@
 
 class Renderer {
  public:
+  // Where frames are drawn: a window on screen, or an in-memory surface
+  // that needs no display (used by benchmarks)
+  enum class Target { kWindow, kOffscreen };
+
   Renderer(const std::size_t screen_width, const std::size_t screen_height,
-           const std::size_t grid_width, const std::size_t grid_height);
+           const std::size_t grid_width, const std::size_t grid_height,
+           Target target = Target::kWindow);
   ~Renderer();
 
-  // Updated render method to handle all game entities
-  void Render(Snake const &player_snake, AISnake const &ai_snake,
-              const std::vector<std::unique_ptr<Food>>& foods,
-              ObstacleManager const &obstacles, bool render_ai = true);
+  // Updated render method to handle all game entities. `alpha` in [0, 1] is
+  // how far the frame lies between the previous and the current simulation
+  // tick; snake heads are drawn interpolated between the two.
+  void Render(Snake const &player_snake,
+              std::vector<AISnake> const &ai_snakes,
+              const std::vector<Food>& foods,
+              const FoodRegistry& food_types,
+              ObstacleManager const &obstacles, bool render_ai = true,
+              float alpha = 1.0f);
 
   // Updated to show both player and AI scores
   void UpdateWindowTitle(int player_score, int ai_score, int fps);
 
  private:
-  SDL_Window *sdl_window;
-  SDL_Renderer *sdl_renderer;
+  SDL_Window *sdl_window{nullptr};
+  SDL_Surface *sdl_surface{nullptr};
+  SDL_Renderer *sdl_renderer{nullptr};
 
   const std::size_t screen_width;
   const std::size_t screen_height;
@@ -33,8 +44,9 @@ class Renderer {
   const std::size_t grid_height;
 
   // Helper methods for rendering different entities
-  void RenderSnake(Snake const &snake, bool is_player);
-  void RenderFoods(const std::vector<std::unique_ptr<Food>>& foods);
+  void RenderSnake(Snake const &snake, bool is_player, float alpha);
+  void RenderFoods(const std::vector<Food>& foods,
+                   const FoodRegistry& food_types);
   void RenderObstacles(ObstacleManager const &obstacles);
 };
 
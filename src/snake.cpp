@@ -1,16 +1,15 @@
 #include "snake.h"
-#include <cmath>
 #include <iostream>
 
 void Snake::Update() {
-  SDL_Point prev_cell{
-      static_cast<int>(head_x),
-      static_cast<int>(
-          head_y)};  // We first capture the head's cell before updating.
-  UpdateHead();
-  SDL_Point current_cell{
-      static_cast<int>(head_x),
-      static_cast<int>(head_y)};  // Capture the head's cell after updating.
+  prev_head_x_ = head_x_;
+  prev_head_y_ = head_y_;
+
+  // We first capture the head's cell before updating.
+  SDL_Point prev_cell = HeadCell();
+  Advance(head_x_, head_y_);
+  // Capture the head's cell after updating.
+  SDL_Point current_cell = HeadCell();
 
   // Update all of the body vector items if the snake head has moved to a new
   // cell.
@@ -19,61 +18,134 @@ void Snake::Update() {
   }
 }
 
-void Snake::UpdateHead() {
+SDL_Point Snake::NextHeadCell() const {
+  Subcells x = head_x_;
+  Subcells y = head_y_;
+  Advance(x, y);
+  return SDL_Point{CellOf(x), CellOf(y)};
+}
+
+int Snake::TicksToNextCell() const {
+  bool vertical = direction == Direction::kUp || direction == Direction::kDown;
+  bool backwards = direction == Direction::kUp || direction == Direction::kLeft;
+  // How far the head is into its cell along the axis of travel. Going
+  // backwards it leaves once it passes the cell's own edge, going forwards
+  // once it reaches the next cell's.
+  Subcells into = (vertical ? head_y_ : head_x_) & (kSubcellsPerCell - 1);
+  if (backwards) return into / speed + 1;
+  return (kSubcellsPerCell - into + speed - 1) / speed;
+}
+
+void Snake::Coast(int ticks) {
+  if (ticks <= 0) return;
+  bool vertical = direction == Direction::kUp || direction == Direction::kDown;
+  bool backwards = direction == Direction::kUp || direction == Direction::kLeft;
+  Subcells step = backwards ? -speed : speed;
+  Subcells &axis = vertical ? head_y_ : head_x_;
+
+  // The head stays in its cell, so nothing wraps
+  axis += (ticks - 1) * step;
+  prev_head_x_ = head_x_;
+  prev_head_y_ = head_y_;
+  axis += step;
+}
+
+void Snake::PlaceHead(int x, int y) {
+  head_x_ = prev_head_x_ = x * kSubcellsPerCell;
+  head_y_ = prev_head_y_ = y * kSubcellsPerCell;
+}
+
+void Snake::Advance(Subcells &x, Subcells &y) const {
   switch (direction) {
     case Direction::kUp:
-      head_y -= speed;
+      y -= speed;
       break;
 
     case Direction::kDown:
-      head_y += speed;
+      y += speed;
       break;
 
     case Direction::kLeft:
-      head_x -= speed;
+      x -= speed;
       break;
 
     case Direction::kRight:
-      head_x += speed;
+      x += speed;
       break;
   }
 
-  // Wrap the Snake around to the beginning if going off of the screen.
-  head_x = fmod(head_x + grid_width_, grid_width_);
-  head_y = fmod(head_y + grid_height_, grid_height_);
+  // Wrap the Snake around to the beginning if going off of the screen. A
+  // tick never carries it a whole board, so one correction is enough.
+  const Subcells width = grid_width_ * kSubcellsPerCell;
+  const Subcells height = grid_height_ * kSubcellsPerCell;
+  if (x < 0) {
+    x += width;
+  } else if (x >= width) {
+    x -= width;
+  }
+  if (y < 0) {
+    y += height;
+  } else if (y >= height) {
+    y -= height;
+  }
 }
 
 void Snake::UpdateBody(SDL_Point &current_head_cell, SDL_Point &prev_head_cell) {
-  // Add previous head location to vector
-  body.push_back(prev_head_cell);
+  // Add previous head location to the body
+  body.PushBack(prev_head_cell);
+  if (grid_) grid_->Add(current_head_cell.x, current_head_cell.y, grid_layer_);
 
-  if (!growing) {
-    // Remove the tail from the vector.
-    body.erase(body.begin());
+  if (growing == 0) {
+    // Remove the tail from the body.
+    SDL_Point tail = body.PopFront();
+    if (grid_) grid_->Remove(tail.x, tail.y, grid_layer_);
   } else {
-    growing = false;
+    growing--;
     size++;
   }
 
   // Check if the snake has died.
-  for (auto const &item : body) {
-    if (current_head_cell.x == item.x && current_head_cell.y == item.y) {
-      alive = false;
-    }
+  if (body.Contains(current_head_cell.x, current_head_cell.y)) {
+    alive = false;
   }
 }
 
-void Snake::GrowBody() { growing = true; }
+void Snake::ChangeDirection(Direction input) {
+  Direction opposite = Direction::kUp;
+  switch (input) {
+    case Direction::kUp:
+      opposite = Direction::kDown;
+      break;
+    case Direction::kDown:
+      opposite = Direction::kUp;
+      break;
+    case Direction::kLeft:
+      opposite = Direction::kRight;
+      break;
+    case Direction::kRight:
+      opposite = Direction::kLeft;
+      break;
+  }
+  if (direction != opposite || size == 1) direction = input;
+}
+
+void Snake::GrowBody(int segments) { growing += segments; }
 
-// Inefficient method to check if cell is occupied by snake.
+void Snake::AttachGrid(OccupancyGrid *grid, OccupancyGrid::Layer layer) {
+  grid_ = grid;
+  grid_layer_ = layer;
+  if (!grid_) return;
+
+  grid_->Add(HeadX(), HeadY(), grid_layer_);
+  for (auto const &item : body) {
+    grid_->Add(item.x, item.y, grid_layer_);
+  }
+}
+
+// O(1) check if cell is occupied by snake, via the body's occupancy counts.
 bool Snake::SnakeCell(int x, int y) const {
-  if (x == static_cast<int>(head_x) && y == static_cast<int>(head_y)) {
+  if (x == HeadX() && y == HeadY()) {
     return true;
   }
-  for (auto const &item : body) {
-    if (x == item.x && y == item.y) {
-      return true;
-    }
-  }
-  return false;
+  return body.Contains(x, y);
 }
\ No newline at end of file
@@ -1,46 +1,95 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
-#include <vector>
 #include "SDL.h"
+#include "fixed_point.h"
+#include "occupancy_grid.h"
+#include "snake_body.h"
 
 class Snake {
  public:
   enum class Direction { kUp, kDown, kLeft, kRight };
 
+  // Speeds a snake can have: never so slow it stops, never so fast that
+  // its head skips a cell in one tick
+  static constexpr Subcells kMinSpeed = 1;
+  static constexpr Subcells kMaxSpeed = kSubcellsPerCell;
+
   Snake(int grid_width, int grid_height)
-      : grid_width_(grid_width),
-        grid_height_(grid_height),
-        head_x(grid_width / 2),
-        head_y(grid_height / 2) {}
+      : body(grid_width, grid_height),
+        grid_width_(grid_width),
+        grid_height_(grid_height) {
+    PlaceHead(grid_width / 2, grid_height / 2);
+  }
 
   void Update();
 
-  void GrowBody();
+  // The cell the head is in
+  int HeadX() const { return CellOf(head_x_); }
+  int HeadY() const { return CellOf(head_y_); }
+  SDL_Point HeadCell() const { return SDL_Point{HeadX(), HeadY()}; }
+
+  // The cell the head will be in after the next Update
+  SDL_Point NextHeadCell() const;
+
+  // Updates until the head enters another cell, at the current speed and
+  // direction (at least 1)
+  int TicksToNextCell() const;
+
+  // Do `ticks` Updates at once; they must all leave the head in its cell
+  void Coast(int ticks);
+
+  // Put the head at the corner of a cell, as if it had always been there;
+  // call before AttachGrid()
+  void PlaceHead(int x, int y);
+
+  // The head's exact position in cells now and before the last Update,
+  // for drawing it between ticks
+  float HeadPositionX() const { return ToCells(head_x_); }
+  float HeadPositionY() const { return ToCells(head_y_); }
+  float PrevHeadPositionX() const { return ToCells(prev_head_x_); }
+  float PrevHeadPositionY() const { return ToCells(prev_head_y_); }
+
+  // Turn to the given direction unless it would reverse into the body
+  void ChangeDirection(Direction input);
+
+  // Keep the tail in place for the next `segments` cells moved
+  void GrowBody(int segments = 1);
+  bool IsGrowing() const { return growing > 0; }
+  int PendingGrowth() const { return growing; }
   bool SnakeCell(int x, int y) const;
 
+  // Mirror this snake's cells into a shared occupancy grid from now on
+  void AttachGrid(OccupancyGrid *grid, OccupancyGrid::Layer layer);
+
   Direction direction = Direction::kUp;
 
-  float speed{0.1f};
+  // Sub-cells moved per tick
+  Subcells speed{ToSubcells(0.1)};
   int size{1};
   bool alive{true};
-  std::vector<SDL_Point> body;
+  SnakeBody body;
 
  private:
-  void UpdateHead();
+  // Move a head position one tick's travel along `direction`, wrapping
+  void Advance(Subcells &x, Subcells &y) const;
   void UpdateBody(SDL_Point &current_cell, SDL_Point &prev_cell);
 
-  // These must be declared before head_x/head_y for correct init order
   int grid_width_;
   int grid_height_;
 
- public:
-  // head position - declared after grid dimensions
-  float head_x;
-  float head_y;
+  // Shared world grid kept in sync as the snake moves (may be null)
+  OccupancyGrid *grid_{nullptr};
+  OccupancyGrid::Layer grid_layer_{OccupancyGrid::Layer::kPlayer};
 
- private:
-  bool growing{false};
+  // Head position, and its position before the last Update
+  Subcells head_x_{0};
+  Subcells head_y_{0};
+  Subcells prev_head_x_{0};
+  Subcells prev_head_y_{0};
+
+  // Segments still to grow
+  int growing{0};
 };
 
 #endif
@@ -0,0 +1,28 @@
+#include "snake_body.h"
+
+SnakeBody::SnakeBody(int grid_width, int grid_height)
+    : grid_width_(grid_width),
+      cells_(static_cast<std::size_t>(grid_width) * grid_height),
+      counts_(static_cast<std::size_t>(grid_width) * grid_height, 0) {}
+
+void SnakeBody::PushBack(SDL_Point cell) {
+  // A body can never be longer than the grid; drop the tail if it would be
+  if (size_ == cells_.size()) {
+    PopFront();
+  }
+
+  std::size_t slot = start_ + size_;
+  if (slot >= cells_.size()) slot -= cells_.size();
+  cells_[slot] = cell;
+  size_++;
+  counts_[static_cast<std::size_t>(cell.y) * grid_width_ + cell.x]++;
+}
+
+SDL_Point SnakeBody::PopFront() {
+  SDL_Point tail = cells_[start_];
+  counts_[static_cast<std::size_t>(tail.y) * grid_width_ + tail.x]--;
+  start_++;
+  if (start_ == cells_.size()) start_ = 0;
+  size_--;
+  return tail;
+}
@@ -0,0 +1,86 @@
+#ifndef SNAKE_BODY_H
+#define SNAKE_BODY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+#include "SDL.h"
+
+// Snake body stored as a fixed-capacity ring buffer (tail first, neck last)
+// plus a per-cell occupancy count, so moving, growing and "is this cell part
+// of the body?" are all O(1) regardless of snake length.
+class SnakeBody {
+ public:
+  // Forward iterator over segments from tail to neck
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = SDL_Point;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const SDL_Point *;
+    using reference = const SDL_Point &;
+
+    const_iterator(const SnakeBody *body, std::size_t index)
+        : body_(body), index_(index) {}
+
+    reference operator*() const { return (*body_)[index_]; }
+    pointer operator->() const { return &(*body_)[index_]; }
+    const_iterator &operator++() {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++index_;
+      return tmp;
+    }
+    bool operator==(const const_iterator &other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    const SnakeBody *body_;
+    std::size_t index_;
+  };
+
+  SnakeBody(int grid_width, int grid_height);
+
+  // Append a segment behind the head (the new neck)
+  void PushBack(SDL_Point cell);
+
+  // Remove the tail segment and return it
+  SDL_Point PopFront();
+
+  // O(1) occupancy test
+  bool Contains(int x, int y) const {
+    return counts_[static_cast<std::size_t>(y) * grid_width_ + x] != 0;
+  }
+
+  // Container-style access, index 0 is the tail
+  const SDL_Point &operator[](std::size_t i) const {
+    std::size_t slot = start_ + i;
+    if (slot >= cells_.size()) slot -= cells_.size();
+    return cells_[slot];
+  }
+  const SDL_Point &front() const { return (*this)[0]; }
+  const SDL_Point &back() const { return (*this)[size_ - 1]; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  std::size_t capacity() const { return cells_.size(); }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+
+ private:
+  int grid_width_;
+  std::vector<SDL_Point> cells_;       // ring storage, one slot per grid cell
+  std::vector<std::uint16_t> counts_;  // segments per grid cell
+  std::size_t start_{0};               // slot of the tail segment
+  std::size_t size_{0};
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "space_check.h"
+#include <algorithm>
+
+namespace {
+
+// Kogge-Stone occluded fills: spread `seeds` towards higher (FillUp) or
+// lower (FillDown) bits through runs of set bits in `open`, in six steps
+// whatever the run length
+std::uint64_t FillUp(std::uint64_t seeds, std::uint64_t open) {
+  seeds |= open & (seeds << 1);
+  open &= open << 1;
+  seeds |= open & (seeds << 2);
+  open &= open << 2;
+  seeds |= open & (seeds << 4);
+  open &= open << 4;
+  seeds |= open & (seeds << 8);
+  open &= open << 8;
+  seeds |= open & (seeds << 16);
+  open &= open << 16;
+  return seeds | (open & (seeds << 32));
+}
+
+std::uint64_t FillDown(std::uint64_t seeds, std::uint64_t open) {
+  seeds |= open & (seeds >> 1);
+  open &= open >> 1;
+  seeds |= open & (seeds >> 2);
+  open &= open >> 2;
+  seeds |= open & (seeds >> 4);
+  open &= open >> 4;
+  seeds |= open & (seeds >> 8);
+  open &= open >> 8;
+  seeds |= open & (seeds >> 16);
+  open &= open >> 16;
+  return seeds | (open & (seeds >> 32));
+}
+
+}  // namespace
+
+SpaceCheck::SpaceCheck(int grid_width, int grid_height)
+    : grid_width_(grid_width),
+      grid_height_(grid_height),
+      words_per_row_((grid_width + 63) / 64),
+      blocked_(grid_width, grid_height) {
+  reach_.assign(static_cast<std::size_t>(words_per_row_) * grid_height, 0);
+  row_count_.assign(static_cast<std::size_t>(grid_height), 0);
+  touched_rows_.reserve(static_cast<std::size_t>(grid_height));
+}
+
+int SpaceCheck::Reachable(SDL_Point start, SDL_Point opened, int enough) {
+  bool opened_blocked = blocked_.Test(opened.x, opened.y);
+  blocked_.Set(opened.x, opened.y, false);
+
+  // Only rows the last fill reached need clearing
+  for (int y : touched_rows_) {
+    std::fill_n(&reach_[static_cast<std::size_t>(y) * words_per_row_],
+                words_per_row_, 0);
+    row_count_[y] = 0;
+  }
+  touched_rows_.clear();
+  reached_ = 0;
+
+  reach_[Word(start.x, start.y)] |= std::uint64_t{1} << (start.x & 63);
+  FillRow(start.y);
+
+  // Alternate downward and upward sweeps so growth in either direction
+  // crosses the whole grid in one pass
+  while (reached_ < enough) {
+    bool changed = false;
+    for (int y = 0; y < grid_height_; ++y) changed |= GrowRow(y);
+    for (int y = grid_height_ - 1; y >= 0; --y) changed |= GrowRow(y);
+    if (!changed) break;
+  }
+
+  blocked_.Set(opened.x, opened.y, opened_blocked);
+  return reached_;
+}
+
+bool SpaceCheck::GrowRow(int y) {
+  int up = y == 0 ? grid_height_ - 1 : y - 1;
+  int down = y + 1 == grid_height_ ? 0 : y + 1;
+  std::uint64_t *row = &reach_[static_cast<std::size_t>(y) * words_per_row_];
+  const std::uint64_t *above =
+      &reach_[static_cast<std::size_t>(up) * words_per_row_];
+  const std::uint64_t *below =
+      &reach_[static_cast<std::size_t>(down) * words_per_row_];
+  const std::uint64_t *blocked = blocked_.Row(y);
+
+  bool grew = false;
+  for (int w = 0; w < words_per_row_; ++w) {
+    std::uint64_t open = ~blocked[w] & blocked_.ValidMask(w);
+    std::uint64_t added = (above[w] | below[w]) & open & ~row[w];
+    if (added != 0) {
+      row[w] |= added;
+      grew = true;
+    }
+  }
+  if (grew) FillRow(y);
+  return grew;
+}
+
+void SpaceCheck::FillRow(int y) {
+  std::uint64_t *row = &reach_[static_cast<std::size_t>(y) * words_per_row_];
+  const std::uint64_t *blocked = blocked_.Row(y);
+  const int last = words_per_row_ - 1;
+  const int last_bit = (grid_width_ - 1) & 63;
+  auto open = [&](int w) { return ~blocked[w] & blocked_.ValidMask(w); };
+
+  bool again = true;
+  while (again) {
+    again = false;
+    for (int w = 0; w < words_per_row_; ++w) {
+      row[w] = FillDown(FillUp(row[w], open(w)), open(w));
+    }
+
+    // Carry between the top bit of each word and the bottom bit of the
+    // next, with x = width - 1 wrapping round to x = 0
+    for (int w = 0; w < words_per_row_; ++w) {
+      int top = w == last ? last_bit : 63;
+      int next = w == last ? 0 : w + 1;
+      std::uint64_t top_bit = std::uint64_t{1} << top;
+      if ((row[w] & top_bit) && (open(next) & 1) && !(row[next] & 1)) {
+        row[next] |= 1;
+        again = true;
+      }
+      if ((row[next] & 1) && (open(w) & top_bit) && !(row[w] & top_bit)) {
+        row[w] |= top_bit;
+        again = true;
+      }
+    }
+  }
+
+  int count = 0;
+  for (int w = 0; w < words_per_row_; ++w) {
+    count += __builtin_popcountll(row[w]);
+  }
+  if (row_count_[y] == 0) touched_rows_.push_back(y);
+  reached_ += count - row_count_[y];
+  row_count_[y] = count;
+}
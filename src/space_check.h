@@ -0,0 +1,59 @@
+#ifndef SPACE_CHECK_H
+#define SPACE_CHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SDL.h"
+#include "grid_bits.h"
+#include "occupancy_grid.h"
+
+// Counts the free cells reachable from a cell, to tell whether a move
+// leaves a snake enough room to live in. The grid is held as a bitboard,
+// one bit per cell and whole 64-bit words per row, and the flood fill grows
+// a word at a time: runs along a row fill with shifts, rows feed the rows
+// above and below, and sweeps repeat until nothing changes or enough cells
+// are reached. The board of blocked cells is a GridBits, kept current
+// through the world's change journal.
+class SpaceCheck {
+ public:
+  SpaceCheck(int grid_width, int grid_height);
+
+  // Bring the board up to date with the world
+  void Sync(const OccupancyGrid& world) { blocked_.Sync(world); }
+
+  // Number of cells reachable from `start`, counting `start` and treating
+  // `opened` (a tail about to move off) as free. Stops as soon as `enough`
+  // cells are reached, so the result is only exact below that.
+  int Reachable(SDL_Point start, SDL_Point opened, int enough);
+
+  // Was the cell reached by the last Reachable()?
+  bool Reached(int x, int y) const {
+    return (reach_[Word(x, y)] >> (x & 63)) & 1;
+  }
+
+ private:
+  std::size_t Word(int x, int y) const {
+    return static_cast<std::size_t>(y) * words_per_row_ + (x >> 6);
+  }
+
+  // Grow row y from its neighbours and along itself; true if it changed
+  bool GrowRow(int y);
+  // Spread reached bits along row y as far as its free runs go, across
+  // word boundaries and around the wrap, and recount the row
+  void FillRow(int y);
+
+  int grid_width_;
+  int grid_height_;
+  int words_per_row_;
+
+  GridBits blocked_;
+  std::vector<std::uint64_t> reach_;
+  // Reached cells per row, and the rows holding any, kept up to date by
+  // FillRow so a fill neither recounts nor clears the whole board
+  std::vector<int> row_count_;
+  std::vector<int> touched_rows_;
+  int reached_{0};
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include "space_time_planner.h"
+#include <algorithm>
+
+namespace {
+
+// std::push_heap builds a max-heap, so "less" means "expand later"
+struct ExpandLater {
+  template <typename Open>
+  bool operator()(const Open& a, const Open& b) const {
+    if (a.f != b.f) return a.f > b.f;
+    return a.step < b.step;
+  }
+};
+
+}  // namespace
+
+SpaceTimePlanner::SpaceTimePlanner()
+    : table_key_(kTableSize), table_stamp_(kTableSize, 0) {
+  nodes_.reserve(kMaxNodes);
+  open_.reserve(kMaxNodes);
+}
+
+bool SpaceTimePlanner::FindPath(const MotionForecast& forecast,
+                                SDL_Point start, int horizon,
+                                std::vector<SDL_Point>& path) {
+  PlanBudget unlimited;
+  return FindPath(forecast, start, horizon, unlimited, path);
+}
+
+bool SpaceTimePlanner::FindPath(const MotionForecast& forecast,
+                                SDL_Point start, int horizon,
+                                PlanBudget& budget,
+                                std::vector<SDL_Point>& path) {
+  path.clear();
+  expanded_ = 0;
+  if (forecast.goals.empty()) return false;
+  return WithGeometry(GridGeometry(forecast.width, forecast.height),
+                      [&](const auto& grid) {
+                        return Search(grid, forecast, start, horizon, budget,
+                                      path);
+                      });
+}
+
+int SpaceTimePlanner::Distance(const MotionForecast& forecast,
+                               SDL_Point from) const {
+  return Heuristic(GridGeometry(forecast.width, forecast.height), forecast,
+                   from.x, from.y);
+}
+
+template <typename Geometry>
+bool SpaceTimePlanner::Search(const Geometry& grid,
+                              const MotionForecast& forecast, SDL_Point start,
+                              int horizon, PlanBudget& budget,
+                              std::vector<SDL_Point>& path) {
+  horizon = std::min(horizon, kHorizon);
+
+  NextGeneration();
+  nodes_.clear();
+  open_.clear();
+
+  int start_cell = grid.Cell(start.x, start.y);
+  Visit(start_cell, 0);
+  nodes_.push_back({start_cell, 0, -1});
+  open_.push_back({Heuristic(grid, forecast, start.x, start.y), 0, 0});
+  // The expanded state nearest a goal, deepest on ties
+  int best = 0;
+  int best_h = open_.front().f;
+
+  while (!open_.empty()) {
+    if (budget.Expired()) {
+      ReconstructPath(grid, best, path);
+      return false;
+    }
+    std::pop_heap(open_.begin(), open_.end(), ExpandLater());
+    Open current = open_.back();
+    open_.pop_back();
+    const Node node = nodes_[current.node];
+    expanded_++;
+
+    int x = grid.X(node.cell);
+    int y = grid.Y(node.cell);
+    if (node.step > 0 && IsGoal(forecast, x, y)) {
+      ReconstructPath(grid, current.node, path);
+      return true;
+    }
+    int h = current.f - node.step;
+    if (h < best_h || (h == best_h && node.step > nodes_[best].step)) {
+      best = current.node;
+      best_h = h;
+    }
+
+    int step = node.step + 1;
+    if (step > horizon) continue;
+
+    // Four cardinal directions with wrapping
+    const SDL_Point neighbors[4] = {{grid.Right(x), y},
+                                    {grid.Left(x), y},
+                                    {x, grid.Down(y)},
+                                    {x, grid.Up(y)}};
+
+    // Cheapest tests first: the forecast, then the bound, then our own body
+    for (const SDL_Point& n : neighbors) {
+      if (!forecast.IsFree(n.x, n.y, step)) continue;
+      int f = step + Heuristic(grid, forecast, n.x, n.y);
+      if (f > horizon) continue;
+      int next = grid.Cell(n.x, n.y);
+      if (CrossesOwnBody(forecast, current.node, next, step)) continue;
+      if (!Visit(next, step)) continue;
+      if (nodes_.size() >= kMaxNodes) return false;
+
+      nodes_.push_back({next, step, current.node});
+      open_.push_back({f, step, static_cast<int>(nodes_.size() - 1)});
+      std::push_heap(open_.begin(), open_.end(), ExpandLater());
+    }
+  }
+
+  // Nothing reachable within the horizon
+  return false;
+}
+
+template <typename Geometry>
+int SpaceTimePlanner::Heuristic(const Geometry& grid,
+                                const MotionForecast& forecast, int x,
+                                int y) const {
+  // Manhattan distance on the torus to the nearest goal
+  int best = grid.Width() + grid.Height();
+  for (const SDL_Point& goal : forecast.goals) {
+    best = std::min(best, grid.Distance(goal.x, goal.y, x, y));
+  }
+  return best;
+}
+
+bool SpaceTimePlanner::IsGoal(const MotionForecast& forecast, int x,
+                              int y) const {
+  for (const SDL_Point& goal : forecast.goals) {
+    if (goal.x == x && goal.y == y) return true;
+  }
+  return false;
+}
+
+bool SpaceTimePlanner::CrossesOwnBody(const MotionForecast& forecast,
+                                      int parent, int cell, int step) const {
+  // A cell the head left at step j is covered until step j + ai_length + 1.
+  // The start cell (step 0) is already accounted for in the forecast.
+  int oldest = step - forecast.ai_length;
+  for (int n = parent; n >= 0; n = nodes_[n].parent) {
+    if (nodes_[n].step < std::max(oldest, 1)) break;
+    if (nodes_[n].cell == cell) return true;
+  }
+  return false;
+}
+
+bool SpaceTimePlanner::Visit(int cell, int step) {
+  std::uint64_t key = (static_cast<std::uint64_t>(step) << 32) |
+                      static_cast<std::uint32_t>(cell);
+  std::size_t slot =
+      static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 40) &
+      (kTableSize - 1);
+  while (table_stamp_[slot] == generation_) {
+    if (table_key_[slot] == key) return false;
+    slot = (slot + 1) & (kTableSize - 1);
+  }
+  table_stamp_[slot] = generation_;
+  table_key_[slot] = key;
+  return true;
+}
+
+void SpaceTimePlanner::NextGeneration() {
+  generation_++;
+  if (generation_ == 0) {
+    std::fill(table_stamp_.begin(), table_stamp_.end(), 0);
+    generation_ = 1;
+  }
+}
+
+template <typename Geometry>
+void SpaceTimePlanner::ReconstructPath(const Geometry& grid, int node,
+                                       std::vector<SDL_Point>& path) const {
+  // Walk parents back to the start, which is not part of the path
+  for (int n = node; nodes_[n].parent != -1; n = nodes_[n].parent) {
+    path.push_back({grid.X(nodes_[n].cell), grid.Y(nodes_[n].cell)});
+  }
+  std::reverse(path.begin(), path.end());
+}
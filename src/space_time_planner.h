@@ -0,0 +1,94 @@
+#ifndef SPACE_TIME_PLANNER_H
+#define SPACE_TIME_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SDL.h"
+#include "grid_geometry.h"
+#include "motion_forecast.h"
+#include "plan_budget.h"
+
+// A* over (cell, step) pairs: the snake cannot stop, so every move advances
+// time by one step and a cell only has to be clear at the step the head
+// reaches it. This lets paths run through tail cells that will have drained
+// away and around where moving obstacles are going to be, per the
+// MotionForecast. A step horizon and a node budget bound the search; when
+// no food is reachable within them FindPath fails and the caller falls back
+// to a static plan. Visited states live in a generation-stamped open
+// addressing table and all buffers are reused, so searches do not allocate.
+class SpaceTimePlanner {
+ public:
+  static constexpr int kHorizon = 48;
+  static constexpr std::size_t kMaxNodes = 1 << 14;
+
+  SpaceTimePlanner();
+
+  // Find a shortest path from start to the nearest food in
+  // forecast.goals, arriving within `horizon` steps. On success the path
+  // (excluding start, ending at the food) is written into `path` and true
+  // is returned; otherwise `path` is left empty.
+  bool FindPath(const MotionForecast& forecast, SDL_Point start, int horizon,
+                std::vector<SDL_Point>& path);
+
+  // As above, giving up when `budget` expires. `path` then holds the way to
+  // the state searched so far that is nearest a goal, and false is
+  // returned.
+  bool FindPath(const MotionForecast& forecast, SDL_Point start, int horizon,
+                PlanBudget& budget, std::vector<SDL_Point>& path);
+
+  // Steps to the nearest goal with nothing in the way; no path is shorter
+  int Distance(const MotionForecast& forecast, SDL_Point from) const;
+
+  // Nodes expanded by the most recent search
+  std::size_t Expanded() const { return expanded_; }
+
+ private:
+  static constexpr std::size_t kTableSize = kMaxNodes * 2;  // power of two
+
+  struct Node {
+    int cell;
+    int step;
+    int parent;  // index into nodes_, -1 for the start
+  };
+
+  // Open list entry ordered by (f, -step): deeper first on ties
+  struct Open {
+    int f;
+    int step;
+    int node;
+  };
+
+  // The search itself, templated on the board's geometry (see
+  // WithGeometry)
+  template <typename Geometry>
+  bool Search(const Geometry& grid, const MotionForecast& forecast,
+              SDL_Point start, int horizon, PlanBudget& budget,
+              std::vector<SDL_Point>& path);
+
+  template <typename Geometry>
+  int Heuristic(const Geometry& grid, const MotionForecast& forecast, int x,
+                int y) const;
+  bool IsGoal(const MotionForecast& forecast, int x, int y) const;
+
+  // Would the head re-enter a cell its own body still covers?
+  bool CrossesOwnBody(const MotionForecast& forecast, int parent, int cell,
+                      int step) const;
+
+  // Insert (cell, step) if unseen; returns false if it was already there
+  bool Visit(int cell, int step);
+  void NextGeneration();
+
+  template <typename Geometry>
+  void ReconstructPath(const Geometry& grid, int node,
+                       std::vector<SDL_Point>& path) const;
+
+  std::vector<Node> nodes_;
+  std::vector<Open> open_;
+  std::vector<std::uint64_t> table_key_;
+  std::vector<std::uint32_t> table_stamp_;
+  std::uint32_t generation_{0};
+  std::size_t expanded_{0};
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+// Single-producer single-consumer exchange of the latest value of T without
+// locks or allocation. The producer fills WriteBuffer() and calls Publish();
+// the consumer calls Acquire() and reads ReadBuffer(). Each side owns one of
+// three slots outright and they trade the third through an atomic index, so
+// neither side ever waits for the other. Values published while the consumer
+// is busy overwrite each other: the consumer only ever sees the newest.
+template <typename T>
+class TripleBuffer {
+ public:
+  explicit TripleBuffer(const T &initial) : slots_{initial, initial, initial} {}
+
+  // Moving is only valid while neither side is in use
+  TripleBuffer(TripleBuffer &&other) noexcept
+      : slots_(std::move(other.slots_)),
+        back_(other.back_),
+        middle_(other.middle_.load()),
+        front_(other.front_) {}
+  TripleBuffer &operator=(TripleBuffer &&other) noexcept {
+    slots_ = std::move(other.slots_);
+    back_ = other.back_;
+    middle_ = other.middle_.load();
+    front_ = other.front_;
+    return *this;
+  }
+
+  // Producer side
+  T &WriteBuffer() { return slots_[back_]; }
+  void Publish() {
+    std::uint8_t prev =
+        middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+    back_ = prev & kIndexMask;
+  }
+
+  // Consumer side. Returns true if a newer value was published since the
+  // last Acquire(); ReadBuffer() then refers to it.
+  bool Acquire() {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+    std::uint8_t prev =
+        middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = prev & kIndexMask;
+    return true;
+  }
+  bool HasFresh() const {
+    return (middle_.load(std::memory_order_acquire) & kFresh) != 0;
+  }
+  T &ReadBuffer() { return slots_[front_]; }
+
+ private:
+  static constexpr std::uint8_t kIndexMask = 0x3;
+  static constexpr std::uint8_t kFresh = 0x4;
+
+  std::array<T, 3> slots_;
+  std::uint8_t back_{0};                 // producer only
+  std::atomic<std::uint8_t> middle_{1};  // index | kFresh
+  std::uint8_t front_{2};                // consumer only
+};
+
+#endif
@@ -0,0 +1,181 @@
+// Plays the same seeded games twice, once a tick at a time with Step() and
+// once skipping quiet ticks with FastForward(), and checks that both agree
+// on every snake, score and food item whenever they reach the same tick,
+// over several board sizes, AI snake counts and planners.
+//
+// Usage: fast_forward_check
+// Exits non-zero and names the offending game on the first failures.
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "game.h"
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool ok, const std::string &what) {
+  if (!ok) {
+    std::cerr << "FAIL: " << what << "\n";
+    failures++;
+  }
+}
+
+// Turn towards the nearest food, avoiding blocked cells. Derived from the
+// cells of the world only, so it steers the same way through every tick
+// FastForward() skips.
+Game::StepInput Pilot(const Game &game) {
+  const Snake &snake = game.GetSnake();
+  const OccupancyGrid &grid = game.GetGrid();
+  int width = grid.Width();
+  int height = grid.Height();
+  int x = snake.HeadX();
+  int y = snake.HeadY();
+
+  const std::tuple<Snake::Direction, int, int> moves[] = {
+      {Snake::Direction::kUp, x, (y + height - 1) % height},
+      {Snake::Direction::kDown, x, (y + 1) % height},
+      {Snake::Direction::kLeft, (x + width - 1) % width, y},
+      {Snake::Direction::kRight, (x + 1) % width, y}};
+  Game::StepInput input;
+  int best = width + height;
+  for (const auto &move : moves) {
+    int nx = std::get<1>(move);
+    int ny = std::get<2>(move);
+    if (grid.IsBlocked(nx, ny)) continue;
+    SDL_Point food;
+    int distance = width + height;
+    game.GetFoodPool().Nearest(SDL_Point{nx, ny}, food, distance);
+    if (distance < best) {
+      best = distance;
+      input.player_direction = std::get<0>(move);
+    }
+  }
+  return input;
+}
+
+bool SameSnake(const Snake &a, const Snake &b) {
+  if (a.alive != b.alive || a.size != b.size || a.speed != b.speed ||
+      a.direction != b.direction || a.HeadX() != b.HeadX() ||
+      a.HeadY() != b.HeadY() || a.HeadPositionX() != b.HeadPositionX() ||
+      a.HeadPositionY() != b.HeadPositionY() ||
+      a.body.size() != b.body.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < a.body.size(); ++i) {
+    if (a.body[i].x != b.body[i].x || a.body[i].y != b.body[i].y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::tuple<int, int, int>> FoodCells(const Game &game) {
+  std::vector<std::tuple<int, int, int>> cells;
+  for (const Food &food : game.GetFoods()) {
+    cells.emplace_back(food.GetX(), food.GetY(),
+                       static_cast<int>(food.GetType()));
+  }
+  std::sort(cells.begin(), cells.end());
+  return cells;
+}
+
+bool SameGame(const Game &a, const Game &b) {
+  if (a.GetFrameCount() != b.GetFrameCount() ||
+      a.GetScore() != b.GetScore() || a.GetAIScores() != b.GetAIScores() ||
+      a.IsOver() != b.IsOver() || !SameSnake(a.GetSnake(), b.GetSnake()) ||
+      FoodCells(a) != FoodCells(b)) {
+    return false;
+  }
+  const auto &ai_a = a.GetAISnakes();
+  const auto &ai_b = b.GetAISnakes();
+  if (ai_a.size() != ai_b.size()) return false;
+  for (std::size_t i = 0; i < ai_a.size(); ++i) {
+    if (!SameSnake(ai_a[i], ai_b[i])) return false;
+  }
+  const auto &obstacles_a = a.GetObstacles().Positions();
+  const auto &obstacles_b = b.GetObstacles().Positions();
+  for (std::size_t i = 0; i < obstacles_a.size(); ++i) {
+    if (obstacles_a[i].x != obstacles_b[i].x ||
+        obstacles_a[i].y != obstacles_b[i].y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Step one game every tick and fast-forward the other, comparing them
+// after every Step() of the fast-forwarded one
+void Compare(std::size_t width, std::size_t height, std::size_t ai_snakes,
+             const std::string &planner_name, std::uint32_t seed, bool steer,
+             long ticks) {
+  AISnake::Planner planner;
+  AISnake::ParsePlanner(planner_name, planner);
+  Game::Options options;
+  options.enable_ai = ai_snakes > 0;
+  options.num_ai_snakes = std::max<std::size_t>(ai_snakes, 1);
+  options.threaded_ai = false;
+  options.planner = planner;
+  options.seed = seed;
+  Game stepped(width, height, options);
+  Game skipping(width, height, options);
+
+  std::ostringstream name;
+  name << width << "x" << height << ", " << ai_snakes << " AI, "
+       << planner_name << ", seed " << seed
+       << (steer ? ", steered" : "");
+
+  Game::StepInput no_input;
+  long skipped_total = 0;
+  for (long t = 0; t < ticks && !skipping.IsOver(); ++t) {
+    Game::StepInput input = steer ? Pilot(skipping) : no_input;
+    Expect(!steer || Pilot(stepped).player_direction ==
+                         input.player_direction,
+           name.str() + ": pilot disagrees at tick " + std::to_string(t));
+    skipping.Step(input);
+    stepped.Step(input);
+
+    long skipped =
+        skipping.IsOver() ? 0 : skipping.FastForward(ticks - t - 1);
+    for (long k = 0; k < skipped; ++k) stepped.Step(input);
+    t += skipped;
+    skipped_total += skipped;
+
+    if (!SameGame(stepped, skipping)) {
+      Expect(false, name.str() + ": diverged by tick " + std::to_string(t));
+      return;
+    }
+  }
+  // A check that never skips anything checks nothing
+  Expect(skipped_total > 0, name.str() + ": no ticks skipped");
+}
+
+}  // namespace
+
+int main() {
+  const char *planners[] = {"dstar", "astar", "jps", "hpa"};
+  const std::pair<std::size_t, std::size_t> boards[] = {
+      {16, 16}, {32, 32}, {48, 20}};
+
+  for (const auto &board : boards) {
+    for (std::uint32_t seed = 1; seed <= 3; ++seed) {
+      for (bool steer : {false, true}) {
+        Compare(board.first, board.second, 0, planners[0], seed, steer,
+                20000);
+        for (const char *planner : planners) {
+          for (std::size_t ai_snakes : {1, 3}) {
+            Compare(board.first, board.second, ai_snakes, planner, seed,
+                    steer, 5000);
+          }
+        }
+      }
+    }
+  }
+
+  if (failures == 0) std::cout << "fast-forward checks passed\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// Feeds malformed and extreme food type lines to FoodRegistry::Read and
+// plays games with the extreme types it accepts, which must neither crash
+// nor push a snake's speed out of range.
+//
+// Usage: food_registry_check
+// Exits non-zero and names the offending line on the first failure.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "food.h"
+#include "game.h"
+#include "snake.h"
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool ok, const std::string &what) {
+  if (!ok) {
+    std::cerr << "FAIL: " << what << "\n";
+    failures++;
+  }
+}
+
+// Read one line into a fresh registry; true if it was accepted
+bool Accepts(const std::string &line) {
+  FoodRegistry types;
+  std::istringstream in(line);
+  std::string error;
+  bool ok = types.Read(in, error);
+  Expect(ok == error.empty(), "error message iff rejected: " + line);
+  return ok && types.Size() == FoodRegistry().Size() + 1;
+}
+
+// Eat `eats` of one type, checking the speed after each one
+void EatRepeatedly(const FoodTraits &traits, int eats,
+                   const std::string &what) {
+  Snake snake(32, 32);
+  int score = 0;
+  for (int i = 0; i < eats; ++i) {
+    traits.Apply(snake, score);
+    if (snake.speed < Snake::kMinSpeed || snake.speed > Snake::kMaxSpeed) {
+      Expect(false, "speed out of range after eating " + what);
+      return;
+    }
+  }
+}
+
+// Play a game in which nearly all food is of the custom types
+void Play(const std::string &lines, bool fast_forward) {
+  Game::Options options;
+  options.threaded_ai = false;
+  options.seed = 7;
+  std::istringstream in(lines);
+  std::string error;
+  Expect(options.food_types.Read(in, error), "read: " + error);
+  Game game(32, 32, options);
+  Game::StepInput no_input;
+  for (long t = 0; t < 20000 && !game.IsOver(); ++t) {
+    game.Step(no_input);
+    if (fast_forward) t += game.FastForward(20000 - t - 1);
+  }
+}
+
+}  // namespace
+
+int main() {
+  const char *malformed[] = {
+      "1 1 0 0 FFFFFF",            // missing weight
+      "1 1 0 0 FFFFFF 5 extra",    // trailing field
+      "1 1 0 0 GGGGGG 5",          // not hex
+      "1 1 0 0 -FFFFF 5",          // sign in the color
+      "1 1 0 0 FFFFFF -5",         // negative weight
+      "1 1 0 0 FFFFFF 4294967296", // weight beyond 32 bits
+      "1 -1 0 0 FFFFFF 5",         // negative growth
+      "1 100000 0 0 FFFFFF 5",     // growth beyond kMaxGrowth
+      "one 1 0 0 FFFFFF 5",        // not a number
+  };
+  for (const char *line : malformed) {
+    Expect(!Accepts(line), std::string("accepted malformed: ") + line);
+  }
+
+  const char *extreme[] = {
+      "1 0 -1 0 FFFFFF 100000",        // slows to a stop
+      "1 0 -0.5 0.000001 FFFFFF 5",    // min_speed rounds to 0 sub-cells
+      "1 0 40 0 FFFFFF 100000",        // a whole board per tick
+      "1 0 1.5 0 FFFFFF 5",            // more than a cell per tick
+      "1 0 -40000 1 FFFFFF 5",         // overflows sub-cells
+      "1 0 0 2 FFFFFF 5",              // min_speed above a cell per tick
+      "1 0 1e300 0 FFFFFF 5",
+  };
+  for (const char *line : extreme) {
+    Expect(!Accepts(line), std::string("accepted extreme: ") + line);
+  }
+
+  // The fastest and slowest types allowed
+  const std::string fastest = "1 0 1 0 FFFFFF 100000\n";
+  const std::string slowest = "1 0 -1 0.0000153 FFFFFF 100000\n";
+  Expect(Accepts(fastest), "rejected " + fastest);
+  Expect(Accepts(slowest), "rejected " + slowest);
+  for (const std::string &line : {fastest, slowest}) {
+    FoodRegistry types;
+    std::istringstream in(line);
+    std::string error;
+    types.Read(in, error);
+    EatRepeatedly(types.Traits(static_cast<Food::Type>(types.Size() - 1)),
+                  1000, line);
+  }
+  // The built-in speed-ups also stop at one cell per tick
+  FoodRegistry builtin;
+  EatRepeatedly(builtin.Traits(Food::Type::SpeedBoost), 1000, "speed boost");
+  for (bool fast_forward : {false, true}) {
+    Play(fastest, fast_forward);
+    Play(slowest, fast_forward);
+    Play(fastest + slowest, fast_forward);
+  }
+
+  if (failures == 0) std::cout << "food registry checks passed\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+// Runs the path planners on randomized boards that change between queries,
+// with obstacles added and removed, walls across the board and boards
+// that wrap, and checks every path against a breadth-first search: that
+// it steps between neighbouring free cells, ends at the goal, has the
+// shortest length, and that a path is found exactly when one exists. D*
+// Lite keeps repairing one search per goal across the changes, so its
+// repaired paths are held to the same standard as a fresh search's.
+// Hierarchical planning is only meant to come close to the shortest path,
+// so its paths need only be walkable, no shorter than the shortest, and
+// found exactly when one exists.
+//
+// Usage: planner_check
+// Exits non-zero and names the offending board and query on failure.
+
+#include <deque>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "hierarchical_planner.h"
+#include "incremental_planner.h"
+#include "occupancy_grid.h"
+#include "path_planner.h"
+
+namespace {
+
+using Layer = OccupancyGrid::Layer;
+
+int failures = 0;
+
+void Expect(bool ok, const std::string &what) {
+  if (!ok) {
+    std::cerr << "FAIL: " << what << "\n";
+    failures++;
+  }
+}
+
+// Breadth-first distances from every cell of `from` over the wrapping
+// grid, -1 where unreachable
+std::vector<int> Distances(const OccupancyGrid &world,
+                           const std::vector<SDL_Point> &from) {
+  int width = world.Width();
+  int height = world.Height();
+  std::vector<int> distance(static_cast<std::size_t>(width) * height, -1);
+  std::deque<SDL_Point> queue;
+  for (const SDL_Point &cell : from) {
+    distance[cell.y * width + cell.x] = 0;
+    queue.push_back(cell);
+  }
+  while (!queue.empty()) {
+    SDL_Point cell = queue.front();
+    queue.pop_front();
+    int next_distance = distance[cell.y * width + cell.x] + 1;
+    const SDL_Point neighbours[] = {{(cell.x + 1) % width, cell.y},
+                                    {(cell.x + width - 1) % width, cell.y},
+                                    {cell.x, (cell.y + 1) % height},
+                                    {cell.x, (cell.y + height - 1) % height}};
+    for (const SDL_Point &next : neighbours) {
+      int &d = distance[next.y * width + next.x];
+      if (d >= 0 || world.IsBlocked(next.x, next.y)) continue;
+      d = next_distance;
+      queue.push_back(next);
+    }
+  }
+  return distance;
+}
+
+// Does `path` step from start through neighbouring free cells to goal?
+bool Walkable(const OccupancyGrid &world, SDL_Point start, SDL_Point goal,
+              const std::vector<SDL_Point> &path) {
+  if (path.empty()) return false;
+  int width = world.Width();
+  int height = world.Height();
+  SDL_Point at = start;
+  for (const SDL_Point &next : path) {
+    int dx = (next.x - at.x + width) % width;
+    int dy = (next.y - at.y + height) % height;
+    bool step = (dy == 0 && (dx == 1 || dx == width - 1)) ||
+                (dx == 0 && (dy == 1 || dy == height - 1));
+    if (!step || world.IsBlocked(next.x, next.y)) return false;
+    at = next;
+  }
+  return at.x == goal.x && at.y == goal.y;
+}
+
+// A board that changes between queries, as the game's does
+class Board {
+ public:
+  Board(int width, int height, double density, std::uint32_t seed)
+      : world_(width, height), engine_(seed) {
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        if (Chance(density)) world_.Add(x, y, Layer::kObstacle);
+      }
+    }
+  }
+
+  const OccupancyGrid &World() const { return world_; }
+
+  // Block or clear `count` random cells
+  void Toggle(int count) {
+    for (int i = 0; i < count; ++i) {
+      int x = Coordinate(world_.Width());
+      int y = Coordinate(world_.Height());
+      if (world_.Has(x, y, Layer::kObstacle)) {
+        world_.Remove(x, y, Layer::kObstacle);
+      } else {
+        world_.Add(x, y, Layer::kObstacle);
+      }
+    }
+  }
+
+  // Wall off a whole row or column but for a gap or two, so paths have to
+  // find the gap or go round the other way, across the edge
+  void Wall() {
+    bool across = Chance(0.5);
+    int length = across ? world_.Width() : world_.Height();
+    int line = Coordinate(across ? world_.Height() : world_.Width());
+    int gap = Coordinate(length);
+    int other_gap = Chance(0.5) ? Coordinate(length) : gap;
+    for (int i = 0; i < length; ++i) {
+      int x = across ? i : line;
+      int y = across ? line : i;
+      bool open = i == gap || i == other_gap;
+      if (!open && !world_.Has(x, y, Layer::kObstacle)) {
+        world_.Add(x, y, Layer::kObstacle);
+      }
+    }
+  }
+
+  // Drop food on `count` random cells, or take it away where there is some
+  void ToggleFood(int count) {
+    for (int i = 0; i < count; ++i) {
+      int x = Coordinate(world_.Width());
+      int y = Coordinate(world_.Height());
+      if (world_.Has(x, y, Layer::kFood)) {
+        world_.Remove(x, y, Layer::kFood);
+      } else {
+        world_.Add(x, y, Layer::kFood);
+      }
+    }
+  }
+
+  // Food a snake could reach: on cells nothing blocks
+  std::vector<SDL_Point> ReachableFood() const {
+    std::vector<SDL_Point> food;
+    for (int y = 0; y < world_.Height(); ++y) {
+      for (int x = 0; x < world_.Width(); ++x) {
+        if (world_.Has(x, y, Layer::kFood) && !world_.IsBlocked(x, y)) {
+          food.push_back({x, y});
+        }
+      }
+    }
+    return food;
+  }
+
+  // A random free cell, or false if none was found
+  bool FreeCell(SDL_Point &cell) {
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+      cell = {Coordinate(world_.Width()), Coordinate(world_.Height())};
+      if (!world_.IsBlocked(cell.x, cell.y)) return true;
+    }
+    return false;
+  }
+
+  bool Chance(double p) {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(engine_) < p;
+  }
+  int Coordinate(int size) {
+    return std::uniform_int_distribution<int>(0, size - 1)(engine_);
+  }
+
+ private:
+  OccupancyGrid world_;
+  std::mt19937 engine_;
+};
+
+// Check one planner's answer to a query against the breadth-first
+// distance to the goal (-1 if unreachable)
+void CheckPath(const OccupancyGrid &world, SDL_Point start, SDL_Point goal,
+               bool found, const std::vector<SDL_Point> &path, int shortest,
+               const std::string &what) {
+  if (shortest < 0) {
+    Expect(!found && path.empty(), what + ": path to an unreachable goal");
+    return;
+  }
+  if (!found) {
+    Expect(false, what + ": no path, shortest is " +
+                      std::to_string(shortest));
+    return;
+  }
+  Expect(Walkable(world, start, goal, path), what + ": path not walkable");
+  Expect(static_cast<int>(path.size()) == shortest,
+         what + ": length " + std::to_string(path.size()) + ", shortest " +
+             std::to_string(shortest));
+}
+
+// Check a hierarchical plan, which may be longer than the shortest
+void CheckNearPath(const OccupancyGrid &world, SDL_Point start,
+                   SDL_Point goal, bool found,
+                   const std::vector<SDL_Point> &path, int shortest,
+                   const std::string &what) {
+  if (shortest < 0) {
+    Expect(!found && path.empty(), what + ": path to an unreachable goal");
+    return;
+  }
+  if (!found) {
+    Expect(false, what + ": no path, shortest is " +
+                      std::to_string(shortest));
+    return;
+  }
+  Expect(Walkable(world, start, goal, path), what + ": path not walkable");
+  Expect(static_cast<int>(path.size()) >= shortest,
+         what + ": length " + std::to_string(path.size()) +
+             " below the shortest " + std::to_string(shortest));
+}
+
+// Query every planner on one evolving board. The planners live as long as
+// the board, so jump point search's row tables, D* Lite's search trees and
+// the hierarchical planners' clusters follow it through the change journal. D* Lite keeps one goal for several
+// rounds, so most of its searches are repairs.
+void CheckBoard(int width, int height, double density, std::uint32_t seed) {
+  Board board(width, height, density, seed);
+  board.ToggleFood(4);
+  PathPlanner astar(width, height);
+  PathPlanner jps(width, height);
+  jps.SetMode(PathPlanner::Mode::kJumpPoint);
+  IncrementalPlanner dstar(width, height);
+  IncrementalPlanner dstar_food(width, height);
+  SDL_Point dstar_goal{-1, -1};
+  // Clusters as in the game, and small ones that do not divide the board,
+  // so that even small boards have many clusters and ragged edges
+  HierarchicalPlanner hpa(width, height);
+  HierarchicalPlanner hpa_small(width, height, 5);
+  std::vector<SDL_Point> path;
+
+  for (int round = 0; round < 60; ++round) {
+    // Mostly a few changes, as between ticks; now and then more than the
+    // journal holds, which forces a full rebuild
+    if (round % 20 == 19) {
+      board.Toggle(400);
+    } else if (round % 7 == 3) {
+      board.Wall();
+    } else {
+      board.Toggle(board.Coordinate(6));
+    }
+    if (round % 3 == 0) board.ToggleFood(2);
+
+    const OccupancyGrid &world = board.World();
+    if (round % 8 == 0 || dstar_goal.x < 0 ||
+        world.IsBlocked(dstar_goal.x, dstar_goal.y)) {
+      if (!board.FreeCell(dstar_goal)) dstar_goal = {-1, -1};
+    }
+    std::vector<int> to_dstar_goal;
+    if (dstar_goal.x >= 0) to_dstar_goal = Distances(world, {dstar_goal});
+    std::vector<SDL_Point> food = board.ReachableFood();
+    std::vector<int> to_food = Distances(world, food);
+
+    for (int query = 0; query < 4; ++query) {
+      SDL_Point start, goal;
+      if (!board.FreeCell(start) || !board.FreeCell(goal)) continue;
+      if (start.x == goal.x && start.y == goal.y) continue;
+      int shortest = Distances(world, {start})[goal.y * width + goal.x];
+
+      std::ostringstream what;
+      what << width << "x" << height << " density " << density << " seed "
+           << seed << " round " << round << " (" << start.x << ","
+           << start.y << ")->(" << goal.x << "," << goal.y << ")";
+
+      bool found = astar.FindPath(world, start, goal, path);
+      CheckPath(world, start, goal, found, path, shortest,
+                what.str() + " astar");
+      found = jps.FindPath(world, start, goal, path);
+      CheckPath(world, start, goal, found, path, shortest,
+                what.str() + " jps");
+
+      found = hpa.FindPath(world, start, goal, path);
+      CheckNearPath(world, start, goal, found, path, shortest,
+                    what.str() + " hpa");
+      found = hpa_small.FindPath(world, start, goal, path);
+      CheckNearPath(world, start, goal, found, path, shortest,
+                    what.str() + " hpa small clusters");
+
+      // Repaired, then fresh, towards the goal D* Lite is keeping
+      if (dstar_goal.x >= 0 &&
+          (start.x != dstar_goal.x || start.y != dstar_goal.y)) {
+        int to_goal = to_dstar_goal[start.y * width + start.x];
+        found = dstar.FindPath(world, start, dstar_goal, path);
+        CheckPath(world, start, dstar_goal, found, path, to_goal,
+                  what.str() + " dstar repaired");
+        IncrementalPlanner fresh(width, height);
+        found = fresh.FindPath(world, start, dstar_goal, path);
+        CheckPath(world, start, dstar_goal, found, path, to_goal,
+                  what.str() + " dstar fresh");
+      }
+
+      // Towards whichever food is nearest
+      if (!world.Has(start.x, start.y, Layer::kFood)) {
+        int to_nearest = to_food[start.y * width + start.x];
+        found = dstar_food.FindPath(world, start, Layer::kFood, path);
+        SDL_Point end = path.empty() ? start : path.back();
+        Expect(path.empty() || world.Has(end.x, end.y, Layer::kFood),
+               what.str() + " dstar food: path does not end at food");
+        CheckPath(world, start, end, found, path, to_nearest,
+                  what.str() + " dstar food");
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  const std::pair<int, int> sizes[] = {{7, 5},   {16, 16}, {33, 17},
+                                       {64, 64}, {65, 30}, {130, 40}};
+  for (const auto &size : sizes) {
+    for (double density : {0.0, 0.05, 0.2, 0.35}) {
+      for (std::uint32_t seed = 1; seed <= 3; ++seed) {
+        CheckBoard(size.first, size.second, density, seed);
+      }
+    }
+  }
+
+  if (failures == 0) std::cout << "planner checks passed\n";
+  return failures == 0 ? 0 : 1;
+}